@@ -0,0 +1,107 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "geckonator/bench.h"
+
+#include "suite.h"
+
+#define RUNS 8
+#define CHUNK 64
+
+extern uint32_t __etext[];
+extern uint32_t __data_start__[];
+extern uint32_t __data_end__[];
+
+static BENCH_DEFINE(startup, "startup copy");
+static BENCH_DEFINE(memcpy16, "memcpy 16");
+static BENCH_DEFINE(memcpy64, "memcpy 64");
+static BENCH_DEFINE(memcpy256, "memcpy 256");
+static BENCH_DEFINE(memcpy1k, "memcpy 1024");
+static BENCH_DEFINE(memcpy255, "memcpy 255 unaligned");
+
+static uint32_t src[256];
+static uint32_t dst[256];
+
+/* the copy loop of Reset_Handler in init.S */
+static void
+startup_copy(uint32_t *to, const uint32_t *from, const uint32_t *end)
+{
+	uint32_t tmp;
+
+	__asm__ volatile(
+		"	b	2f\n"
+		"1:	ldmia	%1!, {%0}\n"
+		"	stmia	%2!, {%0}\n"
+		"2:	cmp	%2, %3\n"
+		"	blt	1b\n"
+		: "=&l" (tmp), "+l" (from), "+l" (to)
+		: "l" (end)
+		: "cc", "memory");
+}
+
+/*
+ * the data section can't be copied over while running, so the same
+ * number of words is copied from flash into a buffer in chunks
+ */
+static void
+startup_copy_chunks(void)
+{
+	const uint32_t *from = __etext;
+	unsigned int words = __data_end__ - __data_start__;
+
+	while (words) {
+		unsigned int n = (words > CHUNK) ? CHUNK : words;
+
+		startup_copy(dst, from, dst + n);
+		from += n;
+		words -= n;
+	}
+}
+
+void
+bench_copy(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < RUNS; i++) {
+		BENCH_BEGIN(startup);
+		startup_copy_chunks();
+		BENCH_END(startup);
+
+		BENCH_BEGIN(memcpy16);
+		memcpy(dst, src, 16);
+		BENCH_END(memcpy16);
+
+		BENCH_BEGIN(memcpy64);
+		memcpy(dst, src, 64);
+		BENCH_END(memcpy64);
+
+		BENCH_BEGIN(memcpy256);
+		memcpy(dst, src, 256);
+		BENCH_END(memcpy256);
+
+		BENCH_BEGIN(memcpy1k);
+		memcpy(dst, src, 1024);
+		BENCH_END(memcpy1k);
+
+		BENCH_BEGIN(memcpy255);
+		memcpy((uint8_t *)dst + 1, src, 255);
+		BENCH_END(memcpy255);
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/gpio.h"
+#include "geckonator/bench.h"
+
+#include "suite.h"
+
+#define RUNS 16
+
+static BENCH_DEFINE(mode_low, "gpio_mode low");
+static BENCH_DEFINE(mode_high, "gpio_mode high");
+static BENCH_DEFINE(toggle, "gpio_toggle");
+
+/* pins 0-7 and 8-15 have their mode in different registers */
+void
+bench_gpio(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < RUNS; i++) {
+		BENCH_BEGIN(mode_low);
+		gpio_mode(GPIO_PA0, GPIO_MODE_PUSHPULL);
+		BENCH_END(mode_low);
+
+		BENCH_BEGIN(mode_high);
+		gpio_mode(GPIO_PC14, GPIO_MODE_PUSHPULL);
+		BENCH_END(mode_high);
+
+		BENCH_BEGIN(toggle);
+		gpio_toggle(GPIO_PA0);
+		BENCH_END(toggle);
+	}
+
+	gpio_mode(GPIO_PA0, GPIO_MODE_DISABLED);
+	gpio_mode(GPIO_PC14, GPIO_MODE_DISABLED);
+}
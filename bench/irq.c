@@ -0,0 +1,76 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/bench.h"
+
+#include "suite.h"
+
+#define RUNS 16
+
+static BENCH_DEFINE(irq_entry, "irq entry");
+static BENCH_DEFINE(irq_exit, "irq exit");
+static BENCH_DEFINE(irq_round, "irq round trip");
+
+static volatile uint32_t entered;
+static volatile uint32_t taken;
+
+/* nothing else in the suite uses GPIO interrupts */
+void
+GPIO_EVEN_IRQHandler(void)
+{
+	entered = bench_counter();
+	taken++;
+}
+
+/*
+ * entry is from pending the interrupt to the first read of the
+ * counter in the handler, exit from there back to the thread. both
+ * include the DSB and ISB that make sure the pend is taken
+ */
+void
+bench_irq(void)
+{
+	unsigned int i;
+
+	NVIC_ClearPendingIRQ(GPIO_EVEN_IRQn);
+	NVIC_EnableIRQ(GPIO_EVEN_IRQn);
+
+	for (i = 0; i < RUNS; i++) {
+		uint32_t n = taken;
+		uint32_t t0 = bench_counter();
+		uint32_t t1;
+
+		/* the pend is only sure to be taken after the barriers */
+		NVIC_SetPendingIRQ(GPIO_EVEN_IRQn);
+		__DSB();
+		__ISB();
+		t1 = bench_counter();
+
+		if (taken != n) {
+			bench_add(&irq_entry, entered - t0);
+			bench_add(&irq_exit, t1 - entered);
+		}
+
+		BENCH_BEGIN(irq_round);
+		NVIC_SetPendingIRQ(GPIO_EVEN_IRQn);
+		__DSB();
+		__ISB();
+		BENCH_END(irq_round);
+	}
+
+	NVIC_DisableIRQ(GPIO_EVEN_IRQn);
+}
@@ -0,0 +1,72 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/clock.h"
+#include "geckonator/gpio.h"
+#include "geckonator/dma.h"
+#include "geckonator/leuart.h"
+#include "geckonator/console.h"
+#include "geckonator/bench.h"
+
+#include "suite.h"
+
+/*
+ * runs every benchmark and prints "name runs min avg max" in core
+ * cycles on LEUART0 TX at 9600 baud. TIMER0 runs at HFPERCLK/1 which
+ * is HFCORECLK after reset, so a timer tick is a core cycle.
+ */
+#define CONSOLE_TX    GPIO_PB13
+#define CONSOLE_PINS  LEUART_PINS_TX1
+#define CONSOLE_DMA   0
+
+DMA_DESCRIPTORS(dma_table);
+
+void __noreturn
+main(void)
+{
+	clock_timer0_enable();
+	clock_gpio_enable();
+	clock_dma_enable();
+
+	/* LFRCO for the LEUART */
+	clock_le_enable();
+	clock_lfrco_enable();
+	while (!clock_lfrco_ready())
+		/* wait */;
+	clock_lf_config(CLOCK_LFA_DISABLED | CLOCK_LFB_LFRCO | CLOCK_LFC_DISABLED);
+	clock_leuart0_enable();
+
+	gpio_set(CONSOLE_TX);
+	gpio_mode(CONSOLE_TX, GPIO_MODE_PUSHPULL);
+
+	dma_base_set(&dma_table);
+	dma_enable();
+	console_init(CONSOLE_PINS, leuart_clock_div(32768, 9600),
+			CONSOLE_NONE, CONSOLE_NONE, CONSOLE_DMA, NULL);
+
+	bench_init();
+
+	bench_gpio();
+	bench_copy();
+	bench_irq();
+	bench_ws2812();
+
+	bench_dump(console_write);
+
+	while (1)
+		__WFI();
+}
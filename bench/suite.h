@@ -0,0 +1,9 @@
+#ifndef _BENCH_SUITE_H
+#define _BENCH_SUITE_H
+
+void bench_gpio(void);
+void bench_copy(void);
+void bench_irq(void);
+void bench_ws2812(void);
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/ws2812.h"
+#include "geckonator/bench.h"
+
+#include "suite.h"
+
+#define RUNS 8
+
+static BENCH_DEFINE(encode, "ws2812_encode chunk");
+
+static uint8_t data[WS2812_CHUNK];
+static uint16_t frames[2*WS2812_CHUNK];
+
+void
+bench_ws2812(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < WS2812_CHUNK; i++)
+		data[i] = 17*i;
+
+	for (i = 0; i < RUNS; i++) {
+		BENCH_BEGIN(encode);
+		ws2812_encode(frames, data, WS2812_CHUNK);
+		BENCH_END(encode);
+	}
+}
@@ -0,0 +1,145 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/dma.h"
+#include "geckonator/prs.h"
+#include "geckonator/autobaud.h"
+
+#if AUTOBAUD_TIMER == 2
+#include "geckonator/timer2.h"
+#define AUTOBAUD_TIMERn       TIMER2
+#define autobaud_timer_(name, ...) timer2_##name(__VA_ARGS__)
+#define AUTOBAUD_DMAREQ       DMAREQ_TIMER2_CC0
+#elif AUTOBAUD_TIMER == 1
+#include "geckonator/timer1.h"
+#define AUTOBAUD_TIMERn       TIMER1
+#define autobaud_timer_(name, ...) timer1_##name(__VA_ARGS__)
+#define AUTOBAUD_DMAREQ       DMAREQ_TIMER1_CC0
+#else
+#include "geckonator/timer0.h"
+#define AUTOBAUD_TIMERn       TIMER0
+#define autobaud_timer_(name, ...) timer0_##name(__VA_ARGS__)
+#define AUTOBAUD_DMAREQ       DMAREQ_TIMER0_CC0
+#endif
+
+#define AUTOBAUD_DMA \
+	( DMA_CTRL_DST_INC_WORD \
+	| DMA_CTRL_DST_SIZE_WORD \
+	| DMA_CTRL_SRC_INC_NONE \
+	| DMA_CTRL_SRC_SIZE_WORD \
+	| DMA_CTRL_R_POWER_1 \
+	| DMA_CTRL_CYCLE_CTRL_BASIC)
+
+static struct {
+	void (*done)(uint32_t ticks16);
+	unsigned int ch;
+	unsigned int edges;
+	uint32_t capture[AUTOBAUD_EDGES_MAX];
+} autobaud;
+
+static void
+autobaud_dma_handler(unsigned int ch)
+{
+	const uint32_t *t = autobaud.capture;
+	uint32_t min = 0xFFFFU;
+	uint32_t span = 0;
+	uint32_t bits;
+	unsigned int i;
+
+	autobaud_timer_(stop);
+
+	for (i = 1; i < autobaud.edges; i++) {
+		uint32_t d = (t[i] - t[i-1]) & 0xFFFFU;
+
+		span += d;
+		if (d < min)
+			min = d;
+	}
+
+	if (min == 0)
+		min = 1;
+	bits = (span + min/2) / min;
+
+	if (autobaud.done)
+		autobaud.done((16*span + bits/2) / bits);
+}
+
+void
+autobaud_init(gpio_pin_t rx, unsigned int prs_ch, unsigned int dma_ch)
+{
+	struct dma_descriptor *d = dma_primary(dma_ch);
+
+	autobaud.ch = dma_ch;
+
+	/* RX pin level on a PRS channel */
+	gpio_flag_select(rx);
+	gpio_sense_prs_enable();
+	prs_channel_config(prs_ch, PRS_EDGE_OFF | prs_source_gpio(gpio_nr(rx)));
+
+	autobaud_timer_(stop);
+	autobaud_timer_(config, TIMER_CONFIG_UP);
+	autobaud_timer_(top_max);
+	autobaud_timer_(cc_config, 0, TIMER_CC_CONFIG_CAPTURE
+			| TIMER_CC_CONFIG_PRS
+			| TIMER_CC_CONFIG_BOTH
+			| timer_cc_prs_channel(prs_ch));
+
+	d->src_end = (volatile void *)&AUTOBAUD_TIMERn->CC[0].CCV;
+	dma_channel_config(dma_ch, AUTOBAUD_DMAREQ);
+	dma_channel_handler_set(dma_ch, autobaud_dma_handler);
+	dma_flag_done_clear(dma_ch);
+	dma_flag_done_enable(dma_ch);
+	NVIC_EnableIRQ(DMA_IRQn);
+}
+
+int
+autobaud_start(unsigned int edges, void (*done)(uint32_t ticks16))
+{
+	struct dma_descriptor *d = dma_primary(autobaud.ch);
+
+	if (edges < 2 || edges > AUTOBAUD_EDGES_MAX ||
+			dma_channel_enabled(autobaud.ch))
+		return -1;
+
+	autobaud.edges = edges;
+	autobaud.done = done;
+
+	/* empty the capture buffer */
+	(void)autobaud_timer_(cc_value, 0);
+	(void)autobaud_timer_(cc_value, 0);
+
+	d->dst_end = &autobaud.capture[edges - 1];
+	d->control = AUTOBAUD_DMA | (edges - 1) << _DMA_CTRL_N_MINUS_1_SHIFT;
+	dma_channel_enable(autobaud.ch);
+
+	autobaud_timer_(counter_set, 0);
+	autobaud_timer_(start);
+	return 0;
+}
+
+void
+autobaud_cancel(void)
+{
+	dma_channel_disable(autobaud.ch);
+	autobaud_timer_(stop);
+}
+
+uint32_t
+autobaud_busy(void)
+{
+	return dma_channel_enabled(autobaud.ch);
+}
@@ -0,0 +1,146 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "geckonator/bench.h"
+
+#define BENCH_CALIBRATE 16
+
+static struct {
+	struct bench *first;
+	struct bench **last;
+	uint32_t overhead;
+} bench;
+
+void
+bench_init(void)
+{
+	uint32_t overhead = BENCH_MASK;
+	unsigned int i;
+
+	bench.first = NULL;
+	bench.last = &bench.first;
+
+#ifdef BENCH_CASCADE
+	bench_hi_(stop);
+	bench_hi_(config, TIMER_CONFIG_UP | TIMER_CTRL_CLKSEL_TIMEROUF);
+	bench_hi_(top_max);
+	bench_hi_(counter_set, 0);
+	bench_hi_(start);
+#endif
+	bench_lo_(stop);
+	bench_lo_(config, TIMER_CONFIG_UP);
+	bench_lo_(top_max);
+	bench_lo_(counter_set, 0);
+	bench_lo_(start);
+
+	/* the smallest is what the macros cost when nothing disturbs them */
+	for (i = 0; i < BENCH_CALIBRATE; i++) {
+		uint32_t t0 = bench_counter();
+		uint32_t t1 = bench_counter();
+
+		if (((t1 - t0) & BENCH_MASK) < overhead)
+			overhead = (t1 - t0) & BENCH_MASK;
+	}
+	bench.overhead = overhead;
+}
+
+uint32_t
+bench_overhead(void)
+{
+	return bench.overhead;
+}
+
+void
+bench_add(struct bench *b, uint32_t cycles)
+{
+	cycles &= BENCH_MASK;
+	cycles = (cycles > bench.overhead) ? cycles - bench.overhead : 0;
+
+	if (b->runs == 0) {
+		b->next = NULL;
+		*bench.last = b;
+		bench.last = &b->next;
+		b->min = b->max = cycles;
+		b->total = 0;
+	}
+
+	b->runs++;
+	b->total += cycles;
+	if (cycles < b->min)
+		b->min = cycles;
+	if (cycles > b->max)
+		b->max = cycles;
+}
+
+static char *
+bench_utoa(char *p, uint32_t v)
+{
+	char buf[10];
+	unsigned int i = 0;
+
+	do {
+		buf[i++] = '0' + v % 10;
+		v /= 10;
+	} while (v);
+
+	while (i)
+		*p++ = buf[--i];
+	return p;
+}
+
+static void
+bench_write(size_t (*write)(const void *buf, size_t len),
+		const char *buf, size_t len)
+{
+	while (len) {
+		size_t n = write(buf, len);
+
+		buf += n;
+		len -= n;
+	}
+}
+
+/* one "name runs min avg max" line per benchmark, in cycles */
+void
+bench_dump(size_t (*write)(const void *buf, size_t len))
+{
+	struct bench *b;
+	char line[80];
+
+	for (b = bench.first; b; b = b->next) {
+		size_t len = strlen(b->name);
+		char *p = line;
+
+		if (len > sizeof(line) - 4*11 - 2)
+			len = sizeof(line) - 4*11 - 2;
+		memcpy(p, b->name, len);
+		p += len;
+		*p++ = ' ';
+		p = bench_utoa(p, b->runs);
+		*p++ = ' ';
+		p = bench_utoa(p, b->min);
+		*p++ = ' ';
+		p = bench_utoa(p, b->total / b->runs);
+		*p++ = ' ';
+		p = bench_utoa(p, b->max);
+		*p++ = '\r';
+		*p++ = '\n';
+		bench_write(write, line, p - line);
+	}
+}
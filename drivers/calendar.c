@@ -0,0 +1,232 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/swtimer.h"
+#include "geckonator/calendar.h"
+
+#define CALENDAR_FRAC_BITS 40
+#define CALENDAR_FRAC_MASK ((1ULL << CALENDAR_FRAC_BITS) - 1)
+#define CALENDAR_REBASE    (1U << 30)
+
+/* days from 0000-03-01 to 1970-01-01 */
+#define CALENDAR_EPOCH_DAYS 719468U
+
+static struct {
+	struct swtimer rebase;
+	volatile uint32_t seq;
+	volatile uint32_t step;      /* tick length in 2^-40 s */
+	volatile uint32_t base;      /* swtimer_now() of the base */
+	volatile uint64_t ticks;     /* 64 bit ticks at the base */
+	volatile uint64_t seconds;   /* time at the base */
+	volatile uint64_t frac;      /* and its fraction in 2^-40 s */
+} calendar;
+
+/* tick length for a rate in mHz, 0 if it doesn't fit */
+static uint32_t
+calendar_step(uint32_t mhz)
+{
+	uint64_t step;
+
+	if (mhz == 0)
+		return 0;
+	step = (1000ULL << CALENDAR_FRAC_BITS) / mhz;
+	if (step == 0 || step > 0xFFFFFFFFU)
+		return 0;
+	return step;
+}
+
+/* must be called with interrupts disabled */
+static void
+calendar_rebase(void)
+{
+	uint32_t now = swtimer_now();
+	uint32_t d = now - calendar.base;
+	uint64_t x = (uint64_t)d * calendar.step + calendar.frac;
+
+	calendar.base = now;
+	calendar.ticks += d;
+	calendar.seconds += x >> CALENDAR_FRAC_BITS;
+	calendar.frac = x & CALENDAR_FRAC_MASK;
+	calendar.seq++;
+}
+
+static void
+calendar_rebase_fn(struct swtimer *t)
+{
+	uint32_t primask = irq_save();
+
+	calendar_rebase();
+	irq_restore(primask);
+}
+
+/* mhz is the RTC tick rate in mHz, above 256Hz */
+int
+calendar_init(uint32_t mhz)
+{
+	uint32_t step = calendar_step(mhz);
+
+	if (step == 0)
+		return -1;
+
+	swtimer_cancel(&calendar.rebase);
+	calendar.step = step;
+	calendar.base = swtimer_now();
+	calendar.ticks = calendar.base;
+	calendar.seconds = 0;
+	calendar.frac = 0;
+	calendar.seq++;
+
+	calendar.rebase.fn = calendar_rebase_fn;
+	calendar.rebase.period = CALENDAR_REBASE;
+	swtimer_after(&calendar.rebase, CALENDAR_REBASE);
+	return 0;
+}
+
+/* time so far was counted at the old rate, from now on at the new one */
+int
+calendar_rate_set(uint32_t mhz)
+{
+	uint32_t step = calendar_step(mhz);
+	uint32_t primask;
+
+	if (step == 0)
+		return -1;
+
+	primask = irq_save();
+	calendar_rebase();
+	calendar.step = step;
+	irq_restore(primask);
+	return 0;
+}
+
+uint64_t
+calendar_ticks(void)
+{
+	uint32_t seq;
+	uint64_t ticks;
+
+	do {
+		seq = calendar.seq;
+		ticks = calendar.ticks + (swtimer_now() - calendar.base);
+	} while (seq != calendar.seq);
+
+	return ticks;
+}
+
+/* seconds since 1970, and if subsec isn't NULL the fraction in 1/65536 s */
+uint64_t
+calendar_seconds(uint16_t *subsec)
+{
+	uint32_t seq;
+	uint64_t seconds;
+	uint64_t x;
+
+	do {
+		seq = calendar.seq;
+		x = (uint64_t)(swtimer_now() - calendar.base) * calendar.step
+			+ calendar.frac;
+		seconds = calendar.seconds + (x >> CALENDAR_FRAC_BITS);
+	} while (seq != calendar.seq);
+
+	if (subsec)
+		*subsec = (x & CALENDAR_FRAC_MASK) >> (CALENDAR_FRAC_BITS - 16);
+	return seconds;
+}
+
+void
+calendar_set(uint64_t seconds, uint16_t subsec)
+{
+	uint32_t primask = irq_save();
+
+	calendar_rebase();
+	calendar.seconds = seconds;
+	calendar.frac = (uint64_t)subsec << (CALENDAR_FRAC_BITS - 16);
+	calendar.seq++;
+	irq_restore(primask);
+}
+
+/*
+ * the divisions by constants are multiplies by their reciprocal and
+ * a shift, checked to be exact over the range they're used in. the
+ * days to date part is Neri and Schneider's, counting years from
+ * March so February comes last
+ */
+void
+calendar_split(uint64_t seconds, struct calendar_date *date)
+{
+	/* 86400 is 128 * 675 */
+	uint32_t days = ((uint32_t)(seconds >> 7) * 3257812231ULL) >> 41;
+	uint32_t s = seconds - (uint64_t)days * 86400;
+	uint32_t hour = (s * 37283) >> 27;
+	uint32_t minute;
+	uint32_t n, c, yc, ny, md;
+
+	s -= hour * 3600;
+	minute = (s * 2185) >> 17;
+	s -= minute * 60;
+
+	date->hour = hour;
+	date->minute = minute;
+	date->second = s;
+
+	/* 1970-01-01 was a Thursday */
+	n = days + 4;
+	date->weekday = n - 7 * (uint32_t)((n * 76695845ULL) >> 29);
+
+	/* centuries, and days into the century */
+	n = 4 * (days + CALENDAR_EPOCH_DAYS) + 3;
+	c = (n * 15051803ULL) >> 41;
+	n = ((n - c * 146097) >> 2) * 4 + 3;
+	/* years into the century, and days into the year */
+	yc = (n * 183735ULL) >> 28;
+	ny = (n - yc * 1461) >> 2;
+	/* month and day */
+	md = 2141 * ny + 197913;
+
+	date->year = 100 * c + yc;
+	date->month = md >> 16;
+	date->day = (((md & 0xFFFFU) * 31345) >> 26) + 1;
+	if (ny >= 306) {
+		date->year++;
+		date->month -= 12;
+	}
+}
+
+/* the weekday is ignored */
+uint64_t
+calendar_join(const struct calendar_date *date)
+{
+	uint32_t y = date->year;
+	uint32_t m = date->month;
+	uint32_t era, yoe, doy, days;
+
+	if (m > 2) {
+		m -= 3;
+	} else {
+		m += 9;
+		y--;
+	}
+
+	era = (y * 5243) >> 21;
+	yoe = y - era * 400;
+	doy = (((153 * m + 2) * 1639) >> 13) + date->day - 1;
+	days = era * 146097 + yoe * 365 + (yoe >> 2) - ((yoe * 41) >> 12)
+		+ doy - CALENDAR_EPOCH_DAYS;
+
+	return (uint64_t)days * 86400
+		+ date->hour * 3600U + date->minute * 60U + date->second;
+}
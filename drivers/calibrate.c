@@ -0,0 +1,219 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "geckonator/clock.h"
+#include "geckonator/calibrate.h"
+
+/* the up counter is 20 bits, leave room for osc being this much fast */
+#define CALIBRATE_COUNT_MAX (_CMU_CALCNT_MASK - _CMU_CALCNT_MASK / 4)
+
+/* the furthest the tuning is moved at once */
+#define CALIBRATE_STEP_MAX  16
+
+static struct {
+	struct swtimer poll;
+	struct calibrate *head;
+	struct calibrate **tail;
+	uint32_t rtc_hz;
+	bool cancelled;
+} calibrate;
+
+static void
+calibrate_begin(void)
+{
+	struct calibrate *c = calibrate.head;
+	uint32_t wait;
+
+	clock_calibration_config(c->osc << _CMU_CALCTRL_UPSEL_SHIFT
+			| (c->ref + 1U) << _CMU_CALCTRL_DOWNSEL_SHIFT);
+	clock_calibration_count_set(c->top);
+	clock_calibration_start();
+
+	wait = (uint64_t)c->top * calibrate.rtc_hz / c->ref_hz + 2;
+	swtimer_after(&calibrate.poll, wait);
+}
+
+static void
+calibrate_queue(struct calibrate *c)
+{
+	uint32_t primask = irq_save();
+
+	if (!c->queued) {
+		c->queued = 1;
+		c->next = NULL;
+		*calibrate.tail = c;
+		calibrate.tail = &c->next;
+		if (calibrate.head == c)
+			calibrate_begin();
+	}
+	irq_restore(primask);
+}
+
+/* the timer is the first member of the job */
+static void
+calibrate_timer_fn(struct swtimer *t)
+{
+	calibrate_queue((struct calibrate *)t);
+}
+
+/* move the tuning by the steps the error is worth */
+static void
+calibrate_tune(struct calibrate *c)
+{
+	int32_t tuning = (c->osc == CALIBRATE_HFRCO)
+		? clock_hfrco_tuning() : clock_auxhfrco_tuning();
+	int32_t err = (int32_t)(c->target_hz - c->hz);
+	int32_t delta;
+
+	if (c->last_hz && tuning != c->last_tuning) {
+		int32_t step = ((int32_t)(c->hz - c->last_hz))
+			/ (tuning - c->last_tuning);
+
+		if (step > 0)
+			c->step = step;
+	}
+	c->last_hz = c->hz;
+	c->last_tuning = tuning;
+
+	if (c->step == 0)
+		delta = (err > 0) - (err < 0);
+	else if (err >= 0)
+		delta = (err + c->step / 2) / c->step;
+	else
+		delta = (err - c->step / 2) / c->step;
+
+	if (delta > CALIBRATE_STEP_MAX)
+		delta = CALIBRATE_STEP_MAX;
+	else if (delta < -CALIBRATE_STEP_MAX)
+		delta = -CALIBRATE_STEP_MAX;
+	tuning += delta;
+	if (tuning < 0)
+		tuning = 0;
+	else if (tuning > 0xFF)
+		tuning = 0xFF;
+
+	if (c->osc == CALIBRATE_HFRCO)
+		clock_hfrco_tuning_set(tuning);
+	else
+		clock_auxhfrco_tuning_set(tuning);
+}
+
+static void
+calibrate_poll_fn(struct swtimer *t)
+{
+	struct calibrate *c;
+	uint32_t primask;
+
+	if (clock_calibration_busy()) {
+		swtimer_after(t, 1);
+		return;
+	}
+
+	primask = irq_save();
+	c = calibrate.head;
+	/* take the result before the next job resets the counter */
+	c->count = clock_calibration_count();
+	calibrate.head = c->next;
+	if (calibrate.head == NULL)
+		calibrate.tail = &calibrate.head;
+	c->queued = 0;
+	if (calibrate.cancelled) {
+		calibrate.cancelled = false;
+		c = NULL;
+	}
+	if (calibrate.head)
+		calibrate_begin();
+	irq_restore(primask);
+
+	if (c == NULL)
+		return;
+
+	c->hz = (uint64_t)c->count * c->ref_hz / c->top;
+	if (c->target_hz && (c->osc == CALIBRATE_HFRCO
+				|| c->osc == CALIBRATE_AUXHFRCO))
+		calibrate_tune(c);
+	if (c->period)
+		swtimer_after(&c->timer, c->period);
+	if (c->done)
+		c->done(c);
+}
+
+/* rtc_hz is the rate swtimer ticks at */
+void
+calibrate_init(uint32_t rtc_hz)
+{
+	calibrate.rtc_hz = rtc_hz;
+	calibrate.head = NULL;
+	calibrate.tail = &calibrate.head;
+	calibrate.cancelled = false;
+	calibrate.poll.fn = calibrate_poll_fn;
+	calibrate.poll.period = 0;
+}
+
+/*
+ * fails if the job is already measuring, osc is measured against
+ * itself or its rate is unknown
+ */
+int
+calibrate_start(struct calibrate *c)
+{
+	uint32_t top;
+
+	if (c->queued || c->osc == c->ref || c->ref_hz == 0 || c->hz == 0)
+		return -1;
+
+	top = (uint64_t)CALIBRATE_COUNT_MAX * c->ref_hz / c->hz;
+	if (top > _CMU_CALCNT_MASK)
+		top = _CMU_CALCNT_MASK;
+	if (top == 0)
+		return -1;
+
+	swtimer_cancel(&c->timer);
+	c->top = top;
+	c->count = 0;
+	c->last_hz = 0;
+	c->step = 0;
+	c->timer.fn = calibrate_timer_fn;
+	c->timer.period = 0;
+	calibrate_queue(c);
+	return 0;
+}
+
+void
+calibrate_stop(struct calibrate *c)
+{
+	uint32_t primask = irq_save();
+	struct calibrate **p;
+
+	swtimer_cancel(&c->timer);
+	if (c->queued) {
+		if (calibrate.head == c) {
+			/* measuring, leave the counters to finish */
+			calibrate.cancelled = true;
+		} else {
+			for (p = &calibrate.head; *p != c; p = &(*p)->next)
+				/* find it */;
+			*p = c->next;
+			if (calibrate.tail == &c->next)
+				calibrate.tail = p;
+			c->queued = 0;
+		}
+	}
+	irq_restore(primask);
+}
@@ -0,0 +1,318 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "geckonator/dma.h"
+#include "geckonator/prs.h"
+#include "geckonator/capture.h"
+
+#if CAPTURE_TIMER == 2
+#include "geckonator/timer2.h"
+#define CAPTURE_TIMERn        TIMER2
+#define capture_timer_(name, ...) timer2_##name(__VA_ARGS__)
+#define CAPTURE_DMAREQ_RISE   DMAREQ_TIMER2_CC0
+#define CAPTURE_DMAREQ_FALL   DMAREQ_TIMER2_CC1
+#define CAPTURE_IRQn          TIMER2_IRQn
+#define CAPTURE_IRQHandler    TIMER2_IRQHandler
+#elif CAPTURE_TIMER == 1
+#include "geckonator/timer1.h"
+#define CAPTURE_TIMERn        TIMER1
+#define capture_timer_(name, ...) timer1_##name(__VA_ARGS__)
+#define CAPTURE_DMAREQ_RISE   DMAREQ_TIMER1_CC0
+#define CAPTURE_DMAREQ_FALL   DMAREQ_TIMER1_CC1
+#define CAPTURE_IRQn          TIMER1_IRQn
+#define CAPTURE_IRQHandler    TIMER1_IRQHandler
+#else
+#include "geckonator/timer0.h"
+#define CAPTURE_TIMERn        TIMER0
+#define capture_timer_(name, ...) timer0_##name(__VA_ARGS__)
+#define CAPTURE_DMAREQ_RISE   DMAREQ_TIMER0_CC0
+#define CAPTURE_DMAREQ_FALL   DMAREQ_TIMER0_CC1
+#define CAPTURE_IRQn          TIMER0_IRQn
+#define CAPTURE_IRQHandler    TIMER0_IRQHandler
+#endif
+
+#if (CAPTURE_BATCH & (CAPTURE_BATCH - 1)) || CAPTURE_BATCH < 2 || CAPTURE_BATCH > 1024
+#error "CAPTURE_BATCH must be a power of 2 from 2 to 1024"
+#endif
+
+#define CAPTURE_DMA \
+	( DMA_CTRL_DST_INC_HALFWORD \
+	| DMA_CTRL_DST_SIZE_HALFWORD \
+	| DMA_CTRL_SRC_INC_NONE \
+	| DMA_CTRL_SRC_SIZE_HALFWORD \
+	| DMA_CTRL_R_POWER_1 \
+	| DMA_CTRL_CYCLE_CTRL_PINGPONG \
+	| (CAPTURE_BATCH - 1) << _DMA_CTRL_N_MINUS_1_SHIFT)
+
+enum capture_sync {
+	CAPTURE_FIRST,   /* no batch seen yet */
+	CAPTURE_RISE,    /* fall[k] follows rise[k] */
+	CAPTURE_FALL,    /* fall[k+1] follows rise[k] */
+};
+
+static struct {
+	void (*done)(const struct capture_batch *b);
+	uint32_t tick_hz;
+	uint32_t wraps;
+	uint32_t last;
+	uint32_t ext[2];
+	unsigned int rise_ch;
+	unsigned int fall_ch;
+	unsigned int filled[2];
+	enum capture_sync sync;
+	gpio_pin_t in;
+	bool high;
+	uint16_t prev_rise;
+	uint16_t rise[2][CAPTURE_BATCH];
+	uint16_t fall[2][CAPTURE_BATCH];
+} capture;
+
+/* 32 bit time of a capture taken less than 65536 ticks ago */
+static uint32_t
+capture_extend(uint16_t c)
+{
+	uint32_t of;
+	uint32_t cnt;
+	uint32_t now;
+
+	do {
+		of = capture_timer_(flag_overflow, capture_timer_(flags));
+		cnt = capture_timer_(counter);
+	} while (of != capture_timer_(flag_overflow, capture_timer_(flags)));
+
+	now = (capture.wraps + (of ? 1 : 0)) << 16 | cnt;
+	if (c > cnt)
+		now -= 0x10000U;
+	return (now & ~0xFFFFU) | c;
+}
+
+static void
+capture_arm(struct dma_descriptor *d, uint16_t *buf)
+{
+	d->dst_end = &buf[CAPTURE_BATCH - 1];
+	d->control = CAPTURE_DMA;
+}
+
+static void
+capture_process(unsigned int h)
+{
+	const uint16_t *rise = capture.rise[h];
+	const uint16_t *fall = capture.fall[h];
+	struct capture_batch b;
+	uint32_t high = 0;
+	unsigned int k;
+
+	if (capture.sync == CAPTURE_FIRST) {
+		uint16_t d = fall[0] - rise[0];
+		uint16_t p = rise[1] - rise[0];
+
+		/* the pin level at start settles it for slow inputs */
+		if (p < 0x8000U)
+			capture.sync = (d < p) ? CAPTURE_RISE : CAPTURE_FALL;
+		else
+			capture.sync = capture.high ? CAPTURE_FALL : CAPTURE_RISE;
+
+		capture.prev_rise = rise[CAPTURE_BATCH - 1];
+		capture.last = capture.ext[h];
+		return;
+	}
+
+	if (capture.sync == CAPTURE_RISE) {
+		for (k = 0; k < CAPTURE_BATCH; k++)
+			high += (uint16_t)(fall[k] - rise[k]);
+	} else {
+		high += (uint16_t)(fall[0] - capture.prev_rise);
+		for (k = 0; k < CAPTURE_BATCH - 1; k++)
+			high += (uint16_t)(fall[k + 1] - rise[k]);
+	}
+	capture.prev_rise = rise[CAPTURE_BATCH - 1];
+
+	b.ticks = capture.ext[h] - capture.last;
+	capture.last = capture.ext[h];
+	if (b.ticks == 0)
+		return;
+	b.high = high;
+	b.period = (uint32_t)(((uint64_t)b.ticks << 8) / CAPTURE_BATCH);
+	b.freq = (uint32_t)((uint64_t)capture.tick_hz * 1000U * CAPTURE_BATCH / b.ticks);
+	b.duty = (high >= b.ticks) ? 0xFFFFU : (uint16_t)(((uint64_t)high << 16) / b.ticks);
+	b.status = CAPTURE_OK;
+
+	if (capture.done)
+		capture.done(&b);
+}
+
+static void
+capture_filled(unsigned int ch, unsigned int bit)
+{
+	/* the descriptor which just finished is the one not in use now */
+	unsigned int h = dma_channel_alternate(ch) ? 0 : 1;
+	struct dma_descriptor *d = h ? dma_alternate(ch) : dma_primary(ch);
+
+	capture_arm(d, (ch == capture.rise_ch) ? capture.rise[h] : capture.fall[h]);
+
+	capture.filled[h] |= bit;
+	if (capture.filled[h] == 3) {
+		capture.filled[h] = 0;
+		capture_process(h);
+	}
+}
+
+static void
+capture_dma_rise_handler(unsigned int ch)
+{
+	unsigned int h = dma_channel_alternate(ch) ? 0 : 1;
+
+	/* extend right away, the fall half may take another period */
+	capture.ext[h] = capture_extend(capture.rise[h][CAPTURE_BATCH - 1]);
+	capture_filled(ch, 1);
+}
+
+static void
+capture_dma_fall_handler(unsigned int ch)
+{
+	capture_filled(ch, 2);
+}
+
+static void
+capture_restart(void)
+{
+	unsigned int ch;
+
+	dma_channel_disable(capture.rise_ch);
+	dma_channel_disable(capture.fall_ch);
+
+	/* empty the capture buffers */
+	(void)capture_timer_(cc_value, 0);
+	(void)capture_timer_(cc_value, 0);
+	(void)capture_timer_(cc_value, 1);
+	(void)capture_timer_(cc_value, 1);
+
+	ch = capture.rise_ch;
+	capture_arm(dma_primary(ch), capture.rise[0]);
+	capture_arm(dma_alternate(ch), capture.rise[1]);
+	dma_channel_alternate_disable(ch);
+	ch = capture.fall_ch;
+	capture_arm(dma_primary(ch), capture.fall[0]);
+	capture_arm(dma_alternate(ch), capture.fall[1]);
+	dma_channel_alternate_disable(ch);
+
+	capture.filled[0] = capture.filled[1] = 0;
+	capture.sync = CAPTURE_FIRST;
+
+	capture_timer_(flags_clear, TIMER_IFC_ICBOF0 | TIMER_IFC_ICBOF1);
+	dma_channel_enable(capture.rise_ch);
+	dma_channel_enable(capture.fall_ch);
+	capture.high = gpio_in(capture.in) != 0;
+}
+
+void
+CAPTURE_IRQHandler(void)
+{
+	uint32_t flags = capture_timer_(flags);
+
+	capture_timer_(flags_clear, flags);
+
+	if (capture_timer_(flag_overflow, flags))
+		capture.wraps++;
+
+	if (flags & (TIMER_IF_ICBOF0 | TIMER_IF_ICBOF1)) {
+		struct capture_batch b = { .status = CAPTURE_OVERFLOW };
+		uint32_t primask = irq_save();
+
+		capture_restart();
+		irq_restore(primask);
+		if (capture.done)
+			capture.done(&b);
+	}
+}
+
+void
+capture_init(gpio_pin_t in, unsigned int prs_ch,
+		unsigned int rise_ch, unsigned int fall_ch,
+		uint32_t hfperclk, unsigned int shift)
+{
+	capture.in = in;
+	capture.tick_hz = hfperclk >> shift;
+	capture.rise_ch = rise_ch;
+	capture.fall_ch = fall_ch;
+	capture.wraps = 0;
+
+	/* input level on a PRS channel */
+	gpio_flag_select(in);
+	gpio_sense_prs_enable();
+	prs_channel_config(prs_ch, PRS_EDGE_OFF | prs_source_gpio(gpio_nr(in)));
+
+	capture_timer_(stop);
+	capture_timer_(config, TIMER_CONFIG_UP | timer_prescaler(shift));
+	capture_timer_(top_max);
+	capture_timer_(cc_config, 0, TIMER_CC_CONFIG_CAPTURE
+			| TIMER_CC_CONFIG_PRS
+			| TIMER_CC_CONFIG_RISING
+			| timer_cc_prs_channel(prs_ch));
+	capture_timer_(cc_config, 1, TIMER_CC_CONFIG_CAPTURE
+			| TIMER_CC_CONFIG_PRS
+			| TIMER_CC_CONFIG_FALLING
+			| timer_cc_prs_channel(prs_ch));
+
+	dma_primary(rise_ch)->src_end = (volatile void *)&CAPTURE_TIMERn->CC[0].CCV;
+	dma_alternate(rise_ch)->src_end = (volatile void *)&CAPTURE_TIMERn->CC[0].CCV;
+	dma_channel_config(rise_ch, CAPTURE_DMAREQ_RISE);
+	dma_channel_handler_set(rise_ch, capture_dma_rise_handler);
+	dma_flag_done_clear(rise_ch);
+	dma_flag_done_enable(rise_ch);
+
+	dma_primary(fall_ch)->src_end = (volatile void *)&CAPTURE_TIMERn->CC[1].CCV;
+	dma_alternate(fall_ch)->src_end = (volatile void *)&CAPTURE_TIMERn->CC[1].CCV;
+	dma_channel_config(fall_ch, CAPTURE_DMAREQ_FALL);
+	dma_channel_handler_set(fall_ch, capture_dma_fall_handler);
+	dma_flag_done_clear(fall_ch);
+	dma_flag_done_enable(fall_ch);
+
+	NVIC_EnableIRQ(DMA_IRQn);
+	NVIC_EnableIRQ(CAPTURE_IRQn);
+}
+
+void
+capture_start(void (*done)(const struct capture_batch *b))
+{
+	uint32_t primask = irq_save();
+
+	capture.done = done;
+	capture.wraps = 0;
+	capture_timer_(counter_set, 0);
+	capture_timer_(flags_clear, TIMER_IFC_OF | TIMER_IFC_ICBOF0 | TIMER_IFC_ICBOF1);
+	capture_timer_(flag_overflow_enable);
+	capture_timer_(flag_cc_overflow_enable, 0);
+	capture_timer_(flag_cc_overflow_enable, 1);
+
+	capture_restart();
+	capture_timer_(start);
+	irq_restore(primask);
+}
+
+void
+capture_stop(void)
+{
+	capture_timer_(stop);
+	capture_timer_(flag_overflow_disable);
+	capture_timer_(flag_cc_overflow_disable, 0);
+	capture_timer_(flag_cc_overflow_disable, 1);
+	dma_channel_disable(capture.rise_ch);
+	dma_channel_disable(capture.fall_ch);
+}
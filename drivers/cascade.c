@@ -0,0 +1,245 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/prs.h"
+#include "geckonator/cascade.h"
+
+#if CASCADE_LOW == CASCADE_HIGH
+#error "CASCADE_LOW and CASCADE_HIGH must be different TIMERs"
+#endif
+
+#if CASCADE_LOW == 2
+#include "geckonator/timer2.h"
+#define cascade_lo_(name, ...) timer2_##name(__VA_ARGS__)
+#define CASCADE_LO_IRQn        TIMER2_IRQn
+#define CASCADE_LO_IRQHandler  TIMER2_IRQHandler
+#define CASCADE_PRS_SOURCE     PRS_SOURCE_TIMER2_OF
+#elif CASCADE_LOW == 1
+#include "geckonator/timer1.h"
+#define cascade_lo_(name, ...) timer1_##name(__VA_ARGS__)
+#define CASCADE_LO_IRQn        TIMER1_IRQn
+#define CASCADE_LO_IRQHandler  TIMER1_IRQHandler
+#define CASCADE_PRS_SOURCE     PRS_SOURCE_TIMER1_OF
+#else
+#include "geckonator/timer0.h"
+#define cascade_lo_(name, ...) timer0_##name(__VA_ARGS__)
+#define CASCADE_LO_IRQn        TIMER0_IRQn
+#define CASCADE_LO_IRQHandler  TIMER0_IRQHandler
+#define CASCADE_PRS_SOURCE     PRS_SOURCE_TIMER0_OF
+#endif
+
+#if CASCADE_HIGH == 2
+#include "geckonator/timer2.h"
+#define cascade_hi_(name, ...) timer2_##name(__VA_ARGS__)
+#define CASCADE_HI_IRQn        TIMER2_IRQn
+#define CASCADE_HI_IRQHandler  TIMER2_IRQHandler
+#elif CASCADE_HIGH == 1
+#include "geckonator/timer1.h"
+#define cascade_hi_(name, ...) timer1_##name(__VA_ARGS__)
+#define CASCADE_HI_IRQn        TIMER1_IRQn
+#define CASCADE_HI_IRQHandler  TIMER1_IRQHandler
+#else
+#include "geckonator/timer0.h"
+#define cascade_hi_(name, ...) timer0_##name(__VA_ARGS__)
+#define CASCADE_HI_IRQn        TIMER0_IRQn
+#define CASCADE_HI_IRQHandler  TIMER0_IRQHandler
+#endif
+
+/* HFPERCLK cycles for an overflow to reach the high half, and then some */
+#define CASCADE_SETTLE 4
+
+static struct {
+	void (*compare)(void);
+	void (*capture)(uint32_t t);
+	uint32_t target;
+} cascade;
+
+uint32_t
+cascade_counter(void)
+{
+	uint32_t primask = irq_save();
+	uint32_t before = cascade_hi_(counter);
+	uint32_t lo = cascade_lo_(counter);
+	uint32_t after;
+	unsigned int i;
+
+	for (i = 0; i < CASCADE_SETTLE; i++)
+		__NOP();
+	after = cascade_hi_(counter);
+	irq_restore(primask);
+
+	return ((lo & 0x8000U) ? before : after) << 16 | lo;
+}
+
+/* the high half is there, wait for the low half */
+static void
+cascade_arm_low(void)
+{
+	cascade_lo_(cc_value_set, 0, cascade.target & 0xFFFFU);
+	cascade_lo_(flag_cc0_clear);
+	cascade_lo_(flag_cc0_enable);
+
+	/* it may have gone by already */
+	if ((int32_t)(cascade_counter() - cascade.target) >= 0)
+		cascade_lo_(flag_cc0_set);
+}
+
+void
+CASCADE_HI_IRQHandler(void)
+{
+	uint32_t flags = cascade_hi_(flags);
+
+	cascade_hi_(flags_clear, flags);
+
+	if (cascade_hi_(flag_cc0, flags) && cascade_hi_(flag_cc_enabled, 0)) {
+		cascade_hi_(flag_cc0_disable);
+		cascade_arm_low();
+	}
+}
+
+void
+CASCADE_LO_IRQHandler(void)
+{
+	uint32_t flags = cascade_lo_(flags);
+
+	cascade_lo_(flags_clear, flags);
+
+	if (cascade_lo_(flag_cc0, flags) && cascade_lo_(flag_cc_enabled, 0)
+			&& (int32_t)(cascade_counter() - cascade.target) >= 0) {
+		cascade_lo_(flag_cc0_disable);
+		cascade.compare();
+	}
+
+	while (cascade_lo_(cc2_capture_valid)) {
+		uint32_t c = cascade_lo_(cc_value, 2);
+		uint32_t now = cascade_counter();
+		uint32_t t = (now & ~0xFFFFU) | c;
+
+		if (t > now)
+			t -= 0x10000U;
+		if (cascade.capture)
+			cascade.capture(t);
+	}
+}
+
+void
+cascade_init(unsigned int prs_ch, unsigned int shift)
+{
+	cascade.compare = NULL;
+	cascade.capture = NULL;
+
+	prs_channel_config(prs_ch, PRS_EDGE_OFF | CASCADE_PRS_SOURCE);
+
+	cascade_lo_(stop);
+	cascade_hi_(stop);
+
+	cascade_hi_(config, TIMER_CONFIG_UP | TIMER_CTRL_CLKSEL_CC1);
+	cascade_hi_(top_max);
+	cascade_hi_(counter_set, 0);
+	cascade_hi_(cc_config, 1, TIMER_CC_CONFIG_CAPTURE
+			| TIMER_CC_CONFIG_PRS
+			| TIMER_CC_CONFIG_RISING
+			| timer_cc_prs_channel(prs_ch));
+	cascade_hi_(cc_config, 0, TIMER_CC_CONFIG_COMPARE);
+	cascade_hi_(flags_clear, _TIMER_IFC_MASK);
+
+	cascade_lo_(config, TIMER_CONFIG_UP | timer_prescaler(shift));
+	cascade_lo_(top_max);
+	cascade_lo_(counter_set, 0);
+	cascade_lo_(cc_config, 0, TIMER_CC_CONFIG_COMPARE);
+	cascade_lo_(flags_clear, _TIMER_IFC_MASK);
+
+	NVIC_EnableIRQ(CASCADE_HI_IRQn);
+	NVIC_EnableIRQ(CASCADE_LO_IRQn);
+
+	/* the high half only counts when the low half overflows */
+	cascade_hi_(start);
+	cascade_lo_(start);
+}
+
+/*
+ * call fn from an interrupt when the count reaches t,
+ * or return -1 if it already has
+ */
+int
+cascade_compare(uint32_t t, void (*fn)(void))
+{
+	uint32_t primask = irq_save();
+	uint32_t now;
+
+	cascade_hi_(flag_cc0_disable);
+	cascade_lo_(flag_cc0_disable);
+
+	now = cascade_counter();
+	if ((int32_t)(t - now) <= 0) {
+		irq_restore(primask);
+		return -1;
+	}
+
+	cascade.compare = fn;
+	cascade.target = t;
+
+	if ((t >> 16) == (now >> 16)) {
+		cascade_arm_low();
+	} else {
+		cascade_hi_(cc_value_set, 0, t >> 16);
+		cascade_hi_(flag_cc0_clear);
+		cascade_hi_(flag_cc0_enable);
+		if ((cascade_counter() >> 16) == (t >> 16))
+			cascade_hi_(flag_cc0_set);
+	}
+
+	irq_restore(primask);
+	return 0;
+}
+
+void
+cascade_compare_cancel(void)
+{
+	uint32_t primask = irq_save();
+
+	cascade_hi_(flag_cc0_disable);
+	cascade_lo_(flag_cc0_disable);
+	irq_restore(primask);
+}
+
+/*
+ * fn gets the 32 bit count at every edge of the PRS channel,
+ * edge is TIMER_CC_CONFIG_RISING, _FALLING or _BOTH
+ */
+void
+cascade_capture_start(unsigned int prs_ch, uint32_t edge,
+		void (*fn)(uint32_t t))
+{
+	cascade.capture = fn;
+
+	cascade_lo_(cc_config, 2, TIMER_CC_CONFIG_CAPTURE
+			| TIMER_CC_CONFIG_PRS
+			| edge
+			| timer_cc_prs_channel(prs_ch));
+	(void)cascade_lo_(cc_value, 2);
+	(void)cascade_lo_(cc_value, 2);
+	cascade_lo_(flag_cc2_clear);
+	cascade_lo_(flag_cc2_enable);
+}
+
+void
+cascade_capture_stop(void)
+{
+	cascade_lo_(flag_cc2_disable);
+	cascade_lo_(cc_config, 2, 0);
+}
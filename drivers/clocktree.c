@@ -0,0 +1,434 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/clock.h"
+#include "geckonator/clocktree.h"
+
+/* nominal rates in Hz/1000 by CMU_HFRCOCTRL_BAND and CMU_AUXHFRCOCTRL_BAND */
+static const uint16_t clocktree_hfrco_band[8] = {
+	1000, 7000, 11000, 14000, 21000, 0, 0, 0,
+};
+static const uint16_t clocktree_auxhfrco_band[8] = {
+	14000, 11000, 7000, 1000, 0, 0, 0, 21000,
+};
+
+static struct {
+	uint32_t hz[CLOCKTREE_OSCS];
+	uint32_t hfrco_band;
+	uint8_t users[CLOCKTREE_GATES];
+	uint32_t started;      /* bit per gate clocktree turned on */
+	uint8_t osc_users[CLOCKTREE_OSCS];
+	uint8_t osc_started;   /* bit per oscillator clocktree turned on */
+} clocktree = {
+	.hz = {
+		[CLOCKTREE_HFXO]  = CLOCKTREE_HFXO_HZ,
+		[CLOCKTREE_LFXO]  = CLOCKTREE_LFXO_HZ,
+		[CLOCKTREE_LFRCO] = 32768,
+		[CLOCKTREE_ULFRCO] = 1000,
+	},
+};
+
+static uint32_t
+clocktree_hfrco_band_get(void)
+{
+	return (CMU->HFRCOCTRL & _CMU_HFRCOCTRL_BAND_MASK) >> _CMU_HFRCOCTRL_BAND_SHIFT;
+}
+
+void
+clocktree_osc_set(enum clocktree_osc osc, uint32_t hz)
+{
+	if (osc == CLOCKTREE_HFRCO)
+		clocktree.hfrco_band = clocktree_hfrco_band_get();
+	clocktree.hz[osc] = hz;
+}
+
+uint32_t
+clocktree_osc(enum clocktree_osc osc)
+{
+	uint32_t band;
+
+	switch (osc) {
+	case CLOCKTREE_HFRCO:
+		band = clocktree_hfrco_band_get();
+		if (clocktree.hz[osc] && band == clocktree.hfrco_band)
+			return clocktree.hz[osc];
+		return clocktree_hfrco_band[band] * 1000U;
+	case CLOCKTREE_AUXHFRCO:
+		if (clocktree.hz[osc])
+			return clocktree.hz[osc];
+		band = (CMU->AUXHFRCOCTRL & _CMU_AUXHFRCOCTRL_BAND_MASK)
+			>> _CMU_AUXHFRCOCTRL_BAND_SHIFT;
+		return clocktree_auxhfrco_band[band] * 1000U;
+	case CLOCKTREE_USHFRCO:
+		if (clocktree.hz[osc])
+			return clocktree.hz[osc];
+		if ((CMU->USHFRCOCONF & _CMU_USHFRCOCONF_BAND_MASK)
+				== CMU_USHFRCOCONF_BAND_24MHZ)
+			return 24000000;
+		return 48000000;
+	default:
+		return clocktree.hz[osc];
+	}
+}
+
+uint32_t
+clocktree_hfclk(void)
+{
+	uint32_t status = clock_status();
+	uint32_t div = (CMU->CTRL & _CMU_CTRL_HFCLKDIV_MASK) >> _CMU_CTRL_HFCLKDIV_SHIFT;
+	uint32_t hz;
+
+	if (status & CMU_STATUS_USHFRCODIV2SEL) {
+		hz = clocktree_osc(CLOCKTREE_USHFRCO);
+		if (!(CMU->USHFRCOCONF & CMU_USHFRCOCONF_USHFRCODIV2DIS))
+			hz >>= 1;
+	} else if (status & CMU_STATUS_HFXOSEL) {
+		hz = clocktree_osc(CLOCKTREE_HFXO);
+	} else if (status & CMU_STATUS_LFXOSEL) {
+		hz = clocktree_osc(CLOCKTREE_LFXO);
+	} else if (status & CMU_STATUS_LFRCOSEL) {
+		hz = clocktree_osc(CLOCKTREE_LFRCO);
+	} else {
+		hz = clocktree_osc(CLOCKTREE_HFRCO);
+	}
+
+	if (div)
+		hz /= div + 1;
+	return hz;
+}
+
+uint32_t
+clocktree_hfcoreclk(void)
+{
+	return clocktree_hfclk() >> ((CMU->HFCORECLKDIV
+				& _CMU_HFCORECLKDIV_HFCORECLKDIV_MASK)
+			>> _CMU_HFCORECLKDIV_HFCORECLKDIV_SHIFT);
+}
+
+uint32_t
+clocktree_hfperclk(void)
+{
+	uint32_t v = CMU->HFPERCLKDIV;
+
+	if (!(v & CMU_HFPERCLKDIV_HFPERCLKEN))
+		return 0;
+	return clocktree_hfclk() >> ((v & _CMU_HFPERCLKDIV_HFPERCLKDIV_MASK)
+			>> _CMU_HFPERCLKDIV_HFPERCLKDIV_SHIFT);
+}
+
+/* the LFA and LFB selections are the same, but for their position */
+static uint32_t
+clocktree_lf(uint32_t sel, uint32_t ulfrco)
+{
+	if (ulfrco)
+		return clocktree_osc(CLOCKTREE_ULFRCO);
+
+	switch (sel) {
+	case _CMU_LFCLKSEL_LFA_LFRCO:
+		return clocktree_osc(CLOCKTREE_LFRCO);
+	case _CMU_LFCLKSEL_LFA_LFXO:
+		return clocktree_osc(CLOCKTREE_LFXO);
+	case _CMU_LFCLKSEL_LFA_HFCORECLKLEDIV2:
+		if (CMU->HFCORECLKDIV & CMU_HFCORECLKDIV_HFCORECLKLEDIV)
+			return clocktree_hfcoreclk() >> 2;
+		return clocktree_hfcoreclk() >> 1;
+	default:
+		return 0;
+	}
+}
+
+uint32_t
+clocktree_lfa(void)
+{
+	uint32_t v = CMU->LFCLKSEL;
+
+	return clocktree_lf((v & _CMU_LFCLKSEL_LFA_MASK) >> _CMU_LFCLKSEL_LFA_SHIFT,
+			v & CMU_LFCLKSEL_LFAE);
+}
+
+uint32_t
+clocktree_lfb(void)
+{
+	uint32_t v = CMU->LFCLKSEL;
+
+	return clocktree_lf((v & _CMU_LFCLKSEL_LFB_MASK) >> _CMU_LFCLKSEL_LFB_SHIFT,
+			v & CMU_LFCLKSEL_LFBE);
+}
+
+uint32_t
+clocktree_lfc(void)
+{
+	switch ((CMU->LFCLKSEL & _CMU_LFCLKSEL_LFC_MASK) >> _CMU_LFCLKSEL_LFC_SHIFT) {
+	case _CMU_LFCLKSEL_LFC_LFRCO:
+		return clocktree_osc(CLOCKTREE_LFRCO);
+	case _CMU_LFCLKSEL_LFC_LFXO:
+		return clocktree_osc(CLOCKTREE_LFXO);
+	default:
+		return 0;
+	}
+}
+
+uint32_t
+clocktree_rtc(void)
+{
+	return clocktree_lfa() >> ((CMU->LFAPRESC0 & _CMU_LFAPRESC0_RTC_MASK)
+			>> _CMU_LFAPRESC0_RTC_SHIFT);
+}
+
+uint32_t
+clocktree_leuart0(void)
+{
+	return clocktree_lfb() >> ((CMU->LFBPRESC0 & _CMU_LFBPRESC0_LEUART0_MASK)
+			>> _CMU_LFBPRESC0_LEUART0_SHIFT);
+}
+
+static enum clocktree_gate
+clocktree_parent(enum clocktree_gate g)
+{
+	switch (g) {
+	case CLOCKTREE_RTC:
+	case CLOCKTREE_LEUART0:
+	case CLOCKTREE_USBLE:
+		return CLOCKTREE_LE;
+	case CLOCKTREE_USBC:
+		return CLOCKTREE_USB;
+	default:
+		return CLOCKTREE_GATES;
+	}
+}
+
+static volatile uint32_t *
+clocktree_gate_reg(enum clocktree_gate g, uint32_t *bit)
+{
+	if (g < CLOCKTREE_AES) {
+		*bit = 1U << g;
+		return &CMU->HFPERCLKEN0;
+	}
+	if (g < CLOCKTREE_RTC) {
+		*bit = 1U << (g - CLOCKTREE_AES);
+		return &CMU->HFCORECLKEN0;
+	}
+	if (g == CLOCKTREE_RTC) {
+		*bit = CMU_LFACLKEN0_RTC;
+		return &CMU->LFACLKEN0;
+	}
+	if (g == CLOCKTREE_LEUART0) {
+		*bit = CMU_LFBCLKEN0_LEUART0;
+		return &CMU->LFBCLKEN0;
+	}
+	*bit = CMU_LFCCLKEN0_USBLE;
+	return &CMU->LFCCLKEN0;
+}
+
+/* the LF enables cross into the LF domain, so wait for the last write */
+static void
+clocktree_gate_set(enum clocktree_gate g, uint32_t on)
+{
+	uint32_t bit;
+	volatile uint32_t *reg = clocktree_gate_reg(g, &bit);
+
+	if (g == CLOCKTREE_RTC) {
+		while (clock_lfa_syncbusy())
+			/* wait */;
+	} else if (g == CLOCKTREE_LEUART0) {
+		while (clock_lfb_syncbusy())
+			/* wait */;
+	} else if (g == CLOCKTREE_USBLE) {
+		while (clock_lfc_syncbusy())
+			/* wait */;
+	}
+
+	if (on)
+		*reg |= bit;
+	else
+		*reg &= ~bit;
+}
+
+/*
+ * a gate found on was turned on with clock.h by someone who doesn't
+ * hold it, so only those clocktree turned on itself are turned off
+ */
+void
+clocktree_get(enum clocktree_gate g)
+{
+	uint32_t primask = irq_save();
+	uint32_t bit;
+
+	while (g < CLOCKTREE_GATES) {
+		if (clocktree.users[g]++)
+			break;
+		if (!(*clocktree_gate_reg(g, &bit) & bit)) {
+			clocktree_gate_set(g, 1);
+			clocktree.started |= 1U << g;
+		}
+		g = clocktree_parent(g);
+	}
+	irq_restore(primask);
+}
+
+void
+clocktree_put(enum clocktree_gate g)
+{
+	uint32_t primask = irq_save();
+
+	while (g < CLOCKTREE_GATES) {
+		if (clocktree.users[g] == 0 || --clocktree.users[g])
+			break;
+		if (clocktree.started & (1U << g)) {
+			clocktree_gate_set(g, 0);
+			clocktree.started &= ~(1U << g);
+		}
+		g = clocktree_parent(g);
+	}
+	irq_restore(primask);
+}
+
+static uint32_t
+clocktree_osc_enabled(enum clocktree_osc osc)
+{
+	switch (osc) {
+	case CLOCKTREE_HFXO:
+		return clock_hfxo_enabled();
+	case CLOCKTREE_LFXO:
+		return clock_lfxo_enabled();
+	case CLOCKTREE_HFRCO:
+		return clock_hfrco_enabled();
+	case CLOCKTREE_LFRCO:
+		return clock_lfrco_enabled();
+	case CLOCKTREE_AUXHFRCO:
+		return clock_auxhfrco_enabled();
+	case CLOCKTREE_USHFRCO:
+		return clock_ushfrco_enabled();
+	default:
+		/* the ULFRCO can't be turned off */
+		return 1;
+	}
+}
+
+static void
+clocktree_osc_enable(enum clocktree_osc osc, int on)
+{
+	switch (osc) {
+	case CLOCKTREE_HFXO:
+		if (on)
+			clock_hfxo_enable();
+		else
+			clock_hfxo_disable();
+		break;
+	case CLOCKTREE_LFXO:
+		if (on)
+			clock_lfxo_enable();
+		else
+			clock_lfxo_disable();
+		break;
+	case CLOCKTREE_HFRCO:
+		if (on)
+			clock_hfrco_enable();
+		else
+			clock_hfrco_disable();
+		break;
+	case CLOCKTREE_LFRCO:
+		if (on)
+			clock_lfrco_enable();
+		else
+			clock_lfrco_disable();
+		break;
+	case CLOCKTREE_AUXHFRCO:
+		if (on)
+			clock_auxhfrco_enable();
+		else
+			clock_auxhfrco_disable();
+		break;
+	case CLOCKTREE_USHFRCO:
+		if (on)
+			clock_ushfrco_enable();
+		else
+			clock_ushfrco_disable();
+		break;
+	default:
+		break;
+	}
+}
+
+/* whether the CMU still feeds osc to HFCLK, an LF branch or USBC */
+static uint32_t
+clocktree_osc_routed(enum clocktree_osc osc)
+{
+	uint32_t sel = CMU->LFCLKSEL;
+	uint32_t lf;
+
+	switch (osc) {
+	case CLOCKTREE_HFXO:
+		return clock_hfxo_selected();
+	case CLOCKTREE_HFRCO:
+		return clock_hfrco_selected();
+	case CLOCKTREE_USHFRCO:
+		return clock_ushfrco_selected() || clock_usbc_ushfrco_selected();
+	case CLOCKTREE_LFRCO:
+		if (clock_lfrco_selected() || clock_usbc_lfrco_selected())
+			return 1;
+		lf = _CMU_LFCLKSEL_LFA_LFRCO;
+		break;
+	case CLOCKTREE_LFXO:
+		if (clock_lfxo_selected() || clock_usbc_lfxo_selected())
+			return 1;
+		lf = _CMU_LFCLKSEL_LFA_LFXO;
+		break;
+	default:
+		return 0;
+	}
+
+	/* LFA, LFB and LFC use the same encoding for both */
+	return ((sel & _CMU_LFCLKSEL_LFA_MASK) >> _CMU_LFCLKSEL_LFA_SHIFT) == lf
+		|| ((sel & _CMU_LFCLKSEL_LFB_MASK) >> _CMU_LFCLKSEL_LFB_SHIFT) == lf
+		|| ((sel & _CMU_LFCLKSEL_LFC_MASK) >> _CMU_LFCLKSEL_LFC_SHIFT) == lf;
+}
+
+void
+clocktree_osc_get(enum clocktree_osc osc)
+{
+	uint32_t primask = irq_save();
+
+	if (clocktree.osc_users[osc]++ == 0 && !clocktree_osc_enabled(osc)) {
+		clocktree_osc_enable(osc, 1);
+		clocktree.osc_started |= 1U << osc;
+	}
+	irq_restore(primask);
+}
+
+void
+clocktree_osc_put(enum clocktree_osc osc)
+{
+	uint32_t primask = irq_save();
+
+	if (clocktree.osc_users[osc] && --clocktree.osc_users[osc] == 0
+			&& (clocktree.osc_started & (1U << osc))
+			&& !clocktree_osc_routed(osc)) {
+		clocktree_osc_enable(osc, 0);
+		clocktree.osc_started &= ~(1U << osc);
+	}
+	irq_restore(primask);
+}
+
+void
+clocktree_osc_adopt(enum clocktree_osc osc)
+{
+	uint32_t primask = irq_save();
+
+	clocktree.osc_started |= 1U << osc;
+	irq_restore(primask);
+}
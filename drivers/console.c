@@ -0,0 +1,202 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "geckonator/dma.h"
+#include "geckonator/leuart0.h"
+#include "geckonator/console.h"
+
+#if (CONSOLE_TX_SIZE & (CONSOLE_TX_SIZE - 1)) || CONSOLE_TX_SIZE > 1024
+#error "CONSOLE_TX_SIZE must be a power of 2 no larger than 1024"
+#endif
+
+#define CONSOLE_DMA \
+	( DMA_CTRL_DST_INC_NONE \
+	| DMA_CTRL_DST_SIZE_BYTE \
+	| DMA_CTRL_SRC_INC_BYTE \
+	| DMA_CTRL_SRC_SIZE_BYTE \
+	| DMA_CTRL_R_POWER_1 \
+	| DMA_CTRL_CYCLE_CTRL_BASIC)
+
+static struct {
+	void (*rx)(uint8_t c);
+	unsigned int ch;
+	volatile uint32_t cmd;
+	volatile size_t head;
+	volatile size_t tail;
+	volatile size_t sending;
+	uint8_t buf[CONSOLE_TX_SIZE];
+} console;
+
+/*
+ * a CMD write while the previous one is still crossing into
+ * the LF domain would be lost, so collect them until it's done
+ */
+static void
+console_commit(void)
+{
+	if (console.cmd && !(leuart0_syncbusy() & LEUART_SYNCBUSY_CMD)) {
+		leuart0_command(console.cmd);
+		console.cmd = 0;
+	}
+}
+
+/* send the next contiguous part of the ring, DMA interrupt disabled */
+static void
+console_kick(void)
+{
+	struct dma_descriptor *d = dma_primary(console.ch);
+	size_t tail = console.tail & (CONSOLE_TX_SIZE - 1);
+	size_t len = console.head - console.tail;
+
+	if (console.sending || len == 0)
+		return;
+
+	if (len > CONSOLE_TX_SIZE - tail)
+		len = CONSOLE_TX_SIZE - tail;
+
+	console.sending = len;
+	d->src_end = &console.buf[tail + len - 1];
+	d->control = CONSOLE_DMA | (len - 1) << _DMA_CTRL_N_MINUS_1_SHIFT;
+	dma_channel_enable(console.ch);
+}
+
+static void
+console_dma_handler(unsigned int ch)
+{
+	console.tail += console.sending;
+	console.sending = 0;
+	console_kick();
+	console_commit();
+}
+
+void
+LEUART0_IRQHandler(void)
+{
+	uint32_t flags = leuart0_flags();
+
+	leuart0_flags_clear(flags);
+
+	while (leuart0_rxdata_valid()) {
+		uint8_t c = leuart0_rxdata();
+
+		if (console.rx)
+			console.rx(c);
+	}
+
+	if (leuart0_flag_signal_frame(flags))
+		console.cmd |= LEUART_CMD_RXBLOCKEN;
+
+	console_commit();
+}
+
+void
+console_init(uint32_t pins, uint32_t clkdiv,
+		int start, int signal, unsigned int dma_ch,
+		void (*rx)(uint8_t c))
+{
+	uint32_t config = LEUART_CONFIG_8N1 | LEUART_CONFIG_TX_DMA_WAKEUP;
+	uint32_t cmd = LEUART_CMD_CLEARRX | LEUART_CMD_CLEARTX
+		| LEUART_CMD_RXEN | LEUART_CMD_TXEN;
+
+	console.rx = rx;
+	console.ch = dma_ch;
+	console.cmd = 0;
+	console.head = console.tail = console.sending = 0;
+
+	if (start >= 0) {
+		config |= LEUART_CONFIG_START_FRAME_UNBLOCK;
+		cmd |= LEUART_CMD_RXBLOCKEN;
+	}
+
+	/* everything reaches the LF domain in one go on update */
+	leuart0_freeze();
+	leuart0_config(config);
+	leuart0_clock_div(clkdiv);
+	leuart0_start_frame(start >= 0 ? (uint32_t)start : 0);
+	leuart0_signal_frame(signal >= 0 ? (uint32_t)signal : 0);
+	leuart0_pins(pins);
+	leuart0_command(cmd);
+	leuart0_update();
+
+	leuart0_flags_clear_all();
+	leuart0_flag_rx_data_valid_enable();
+	if (signal >= 0)
+		leuart0_flag_signal_frame_enable();
+
+	dma_primary(dma_ch)->dst_end = &LEUART0->TXDATA;
+	dma_channel_config(dma_ch, DMAREQ_LEUART0_TXBL);
+	dma_channel_handler_set(dma_ch, console_dma_handler);
+	dma_flag_done_clear(dma_ch);
+	dma_flag_done_enable(dma_ch);
+
+	NVIC_EnableIRQ(DMA_IRQn);
+	NVIC_EnableIRQ(LEUART0_IRQn);
+}
+
+size_t
+console_write(const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+	size_t head = console.head;
+	size_t room = CONSOLE_TX_SIZE - (head - console.tail);
+	size_t i;
+
+	if (len > room)
+		len = room;
+
+	for (i = 0; i < len; i++, head++)
+		console.buf[head & (CONSOLE_TX_SIZE - 1)] = p[i];
+
+	NVIC_DisableIRQ(DMA_IRQn);
+	console.head = head;
+	console_kick();
+	NVIC_EnableIRQ(DMA_IRQn);
+
+	return len;
+}
+
+size_t
+console_puts(const char *str)
+{
+	return console_write(str, strlen(str));
+}
+
+/*
+ * blocks for up to a few LFBCLK cycles until the LF domain takes
+ * the last deferred command, the handlers only stay masked for each
+ * attempt so they may commit it themselves meanwhile
+ */
+void
+console_sync(void)
+{
+	while (console.cmd) {
+		NVIC_DisableIRQ(LEUART0_IRQn);
+		NVIC_DisableIRQ(DMA_IRQn);
+		console_commit();
+		NVIC_EnableIRQ(DMA_IRQn);
+		NVIC_EnableIRQ(LEUART0_IRQn);
+	}
+}
+
+uint32_t
+console_busy(void)
+{
+	/* the last character may still be shifting out */
+	return console.head != console.tail;
+}
@@ -0,0 +1,44 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/dma.h"
+
+/*
+ * DMA_IRQHandler shared by the drivers. each driver
+ * registers a handler for the channel(s) it owns.
+ */
+static void (*dma_handlers[DMA_CHAN_COUNT])(unsigned int i);
+
+void
+dma_channel_handler_set(unsigned int i, void (*fn)(unsigned int i))
+{
+	dma_handlers[i] = fn;
+}
+
+void
+DMA_IRQHandler(void)
+{
+	uint32_t flags = dma_flags_enabled(dma_flags());
+	unsigned int i;
+
+	dma_flags_clear(flags);
+
+	for (i = 0; i < DMA_CHAN_COUNT; i++) {
+		if (dma_flag_done(i, flags) && dma_handlers[i])
+			dma_handlers[i](i);
+	}
+}
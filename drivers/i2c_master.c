@@ -0,0 +1,374 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/gpio.h"
+#include "geckonator/i2c0.h"
+#include "geckonator/i2c_master.h"
+#ifdef I2C_MASTER_DMA
+#include "geckonator/dma.h"
+
+#if I2C_MASTER_DMA_MIN < 2
+#error "I2C_MASTER_DMA_MIN must be at least 2"
+#endif
+
+#define I2C_MASTER_DMA_RX \
+	( DMA_CTRL_DST_INC_BYTE \
+	| DMA_CTRL_DST_SIZE_BYTE \
+	| DMA_CTRL_SRC_INC_NONE \
+	| DMA_CTRL_SRC_SIZE_BYTE \
+	| DMA_CTRL_R_POWER_1 \
+	| DMA_CTRL_CYCLE_CTRL_BASIC)
+#define I2C_MASTER_DMA_TX \
+	( DMA_CTRL_DST_INC_NONE \
+	| DMA_CTRL_DST_SIZE_BYTE \
+	| DMA_CTRL_SRC_INC_BYTE \
+	| DMA_CTRL_SRC_SIZE_BYTE \
+	| DMA_CTRL_R_POWER_1 \
+	| DMA_CTRL_CYCLE_CTRL_BASIC)
+#endif
+
+#define I2C_MASTER_FLAGS \
+	( I2C_IEN_NACK \
+	| I2C_IEN_ACK \
+	| I2C_IEN_MSTOP \
+	| I2C_IEN_RXDATAV \
+	| I2C_IEN_ARBLOST \
+	| I2C_IEN_BUSERR \
+	| I2C_IEN_CLTO \
+	| I2C_IEN_BITO)
+
+enum i2c_master_phase {
+	I2C_MASTER_WRITE,
+	I2C_MASTER_READ,
+	I2C_MASTER_STOP,
+};
+
+static struct {
+	struct i2c_transfer *volatile head;
+	struct i2c_transfer *tail;
+	enum i2c_master_phase phase;
+	uint16_t i;
+	uint32_t half;
+	gpio_pin_t scl;
+	gpio_pin_t sda;
+#ifdef I2C_MASTER_DMA
+	unsigned int rx_ch;
+	unsigned int tx_ch;
+#endif
+} i2c_master;
+
+static void
+i2c_master_read(struct i2c_transfer *t)
+{
+	i2c_master.phase = I2C_MASTER_READ;
+	i2c_master.i = 0;
+	i2c0_start();
+	i2c0_txdata(t->address << 1 | 1);
+
+#ifdef I2C_MASTER_DMA
+	/*
+	 * the I2C acks all but the last byte by itself. the DMA
+	 * interrupt turns that off again, and the last byte is
+	 * nacked by the RXDATAV interrupt as usual
+	 */
+	if (t->rlen >= I2C_MASTER_DMA_MIN) {
+		struct dma_descriptor *d = dma_primary(i2c_master.rx_ch);
+
+		i2c0_flag_rx_data_valid_disable();
+		i2c0_autoack_enable();
+		d->dst_end = &t->rbuf[t->rlen - 2];
+		d->control = I2C_MASTER_DMA_RX | (t->rlen - 2) << _DMA_CTRL_N_MINUS_1_SHIFT;
+		dma_channel_enable(i2c_master.rx_ch);
+	}
+#endif
+}
+
+static void
+i2c_master_start(struct i2c_transfer *t)
+{
+	t->status = I2C_MASTER_OK;
+	i2c0_flag_ack_clear();
+	i2c0_flags_enable(I2C_MASTER_FLAGS);
+
+	if (t->wlen == 0 && t->rlen > 0) {
+		i2c_master_read(t);
+		return;
+	}
+
+	i2c_master.phase = I2C_MASTER_WRITE;
+	i2c_master.i = 0;
+	i2c0_start();
+	i2c0_txdata(t->address << 1);
+
+#ifdef I2C_MASTER_DMA
+	/* TXBL only asks for data once the address is in the shift register */
+	if (t->wlen >= I2C_MASTER_DMA_MIN) {
+		struct dma_descriptor *d = dma_primary(i2c_master.tx_ch);
+
+		i2c0_flag_ack_disable();
+		d->src_end = (void *)&t->wbuf[t->wlen - 1];
+		d->control = I2C_MASTER_DMA_TX | (t->wlen - 1) << _DMA_CTRL_N_MINUS_1_SHIFT;
+		dma_channel_enable(i2c_master.tx_ch);
+	}
+#endif
+}
+
+static void
+i2c_master_stop(void)
+{
+	i2c_master.phase = I2C_MASTER_STOP;
+	i2c0_stop();
+}
+
+/* all bytes written and acked */
+static void
+i2c_master_written(struct i2c_transfer *t)
+{
+	if (t->rlen > 0)
+		i2c_master_read(t);
+	else
+		i2c_master_stop();
+}
+
+static void
+i2c_master_done(struct i2c_transfer *t)
+{
+	i2c_master.head = t->next;
+	if (i2c_master.head)
+		i2c_master_start(i2c_master.head);
+	else
+		i2c_master.tail = NULL;
+
+	t->next = NULL;
+	if (t->done)
+		t->done(t);
+}
+
+/* half an SCL period at the standard mode 4:4 clock ratio */
+static void
+i2c_master_delay(void)
+{
+	volatile uint32_t n = i2c_master.half;
+
+	while (n--)
+		;
+}
+
+/* clock out a slave stuck in the middle of a byte */
+static void
+i2c_master_recover(void)
+{
+	unsigned int i;
+
+	i2c0_pins_disable();
+	gpio_set(i2c_master.scl);
+	gpio_set(i2c_master.sda);
+	gpio_mode(i2c_master.scl, GPIO_MODE_WIREDAND);
+	gpio_mode(i2c_master.sda, GPIO_MODE_WIREDAND);
+	i2c_master_delay();
+
+	for (i = 0; i < 9 && !gpio_in(i2c_master.sda); i++) {
+		gpio_clear(i2c_master.scl);
+		i2c_master_delay();
+		gpio_set(i2c_master.scl);
+		i2c_master_delay();
+	}
+
+	/* STOP is SDA going high while SCL is high */
+	gpio_clear(i2c_master.scl);
+	i2c_master_delay();
+	gpio_clear(i2c_master.sda);
+	i2c_master_delay();
+	gpio_set(i2c_master.scl);
+	i2c_master_delay();
+	gpio_set(i2c_master.sda);
+	i2c_master_delay();
+
+	i2c0_pins_enable();
+	i2c0_abort();
+}
+
+#ifdef I2C_MASTER_DMA
+static void
+i2c_master_dma_cancel(void)
+{
+	dma_channel_disable(i2c_master.rx_ch);
+	dma_channel_disable(i2c_master.tx_ch);
+	i2c0_autoack_disable();
+}
+
+static void
+i2c_master_dma_rx_handler(unsigned int ch)
+{
+	i2c0_autoack_disable();
+	i2c_master.i = i2c_master.head->rlen - 1;
+	i2c0_flag_rx_data_valid_enable();
+}
+
+static void
+i2c_master_dma_tx_handler(unsigned int ch)
+{
+	/* the last byte may still be on the bus */
+	i2c_master.i = i2c_master.head->wlen;
+	i2c0_flag_tx_complete_clear();
+	if (i2c0_tx_complete())
+		i2c_master_written(i2c_master.head);
+	else
+		i2c0_flag_tx_complete_enable();
+}
+#else
+static inline void
+i2c_master_dma_cancel(void)
+{
+}
+#endif
+
+void
+I2C0_IRQHandler(void)
+{
+	struct i2c_transfer *t = i2c_master.head;
+	uint32_t flags = i2c0_flags_enabled(i2c0_flags());
+
+	i2c0_flags_clear(flags);
+
+	if (t == NULL)
+		return;
+
+	if (flags & (I2C_IF_ARBLOST | I2C_IF_BUSERR | I2C_IF_CLTO | I2C_IF_BITO)) {
+		/* the I2C has already gone idle on lost arbitration and bus errors */
+		if (i2c0_flag_arbitration_lost(flags))
+			t->status = I2C_MASTER_ARBLOST;
+		else if (i2c0_flag_bus_error(flags))
+			t->status = I2C_MASTER_BUSERR;
+		else {
+			t->status = I2C_MASTER_TIMEOUT;
+			i2c_master_recover();
+		}
+
+		i2c_master_dma_cancel();
+		i2c0_clear_pending();
+		i2c0_clear_tx();
+		while (i2c0_rxdata_valid())
+			(void)i2c0_rxdata();
+		i2c0_flags_clear_all();
+		i2c_master_done(t);
+		return;
+	}
+
+	if (i2c0_flag_nack(flags) && i2c_master.phase != I2C_MASTER_STOP) {
+		t->status = I2C_MASTER_NACK;
+		i2c_master_dma_cancel();
+		i2c0_clear_tx();
+		i2c_master_stop();
+	} else if (i2c0_flag_ack(flags) && i2c_master.phase == I2C_MASTER_WRITE) {
+		if (i2c_master.i < t->wlen)
+			i2c0_txdata(t->wbuf[i2c_master.i++]);
+		else
+			i2c_master_written(t);
+	} else if (i2c0_flag_tx_complete(flags) && i2c_master.phase == I2C_MASTER_WRITE) {
+		i2c0_flag_tx_complete_disable();
+		i2c_master_written(t);
+	}
+
+	if (i2c0_flag_rx_data_valid(flags) && i2c_master.phase == I2C_MASTER_READ) {
+		t->rbuf[i2c_master.i++] = i2c0_rxdata();
+		if (i2c_master.i < t->rlen)
+			i2c0_ack();
+		else {
+			i2c_master.phase = I2C_MASTER_STOP;
+			i2c0_command(I2C_CMD_NACK | I2C_CMD_STOP);
+		}
+	}
+
+	if (i2c0_flag_master_stop(flags))
+		i2c_master_done(t);
+}
+
+void
+i2c_master_init(uint32_t pins, uint32_t clkdiv, uint32_t config,
+		gpio_pin_t scl, gpio_pin_t sda)
+{
+	i2c_master.head = i2c_master.tail = NULL;
+	i2c_master.half = clkdiv + 1;
+	i2c_master.scl = scl;
+	i2c_master.sda = sda;
+
+	gpio_set(scl);
+	gpio_set(sda);
+	gpio_mode(scl, GPIO_MODE_WIREDAND);
+	gpio_mode(sda, GPIO_MODE_WIREDAND);
+
+	i2c0_config(I2C_CONFIG_ENABLE | config);
+	i2c0_clock_div(clkdiv);
+	i2c0_pins(pins);
+
+	if (!gpio_in(sda))
+		i2c_master_recover();
+
+	/* the I2C can't tell the bus is idle until it has seen a STOP */
+	if (i2c0_busy())
+		i2c0_abort();
+
+	i2c0_flags_clear_all();
+	i2c0_flags_enable(I2C_MASTER_FLAGS);
+	NVIC_EnableIRQ(I2C0_IRQn);
+}
+
+#ifdef I2C_MASTER_DMA
+void
+i2c_master_dma(unsigned int rx_ch, unsigned int tx_ch)
+{
+	i2c_master.rx_ch = rx_ch;
+	i2c_master.tx_ch = tx_ch;
+
+	dma_primary(rx_ch)->src_end = (volatile void *)&I2C0->RXDATA;
+	dma_channel_config(rx_ch, DMAREQ_I2C0_RXDATAV);
+	dma_channel_handler_set(rx_ch, i2c_master_dma_rx_handler);
+	dma_flag_done_clear(rx_ch);
+	dma_flag_done_enable(rx_ch);
+
+	dma_primary(tx_ch)->dst_end = &I2C0->TXDATA;
+	dma_channel_config(tx_ch, DMAREQ_I2C0_TXBL);
+	dma_channel_handler_set(tx_ch, i2c_master_dma_tx_handler);
+	dma_flag_done_clear(tx_ch);
+	dma_flag_done_enable(tx_ch);
+
+	NVIC_EnableIRQ(DMA_IRQn);
+}
+#endif
+
+void
+i2c_master_submit(struct i2c_transfer *t)
+{
+	t->next = NULL;
+
+	NVIC_DisableIRQ(I2C0_IRQn);
+	if (i2c_master.tail) {
+		i2c_master.tail->next = t;
+		i2c_master.tail = t;
+	} else {
+		i2c_master.head = i2c_master.tail = t;
+		i2c_master_start(t);
+	}
+	NVIC_EnableIRQ(I2C0_IRQn);
+}
+
+uint32_t
+i2c_master_busy(void)
+{
+	return i2c_master.head != NULL;
+}
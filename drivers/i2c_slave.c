@@ -0,0 +1,134 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/gpio.h"
+#include "geckonator/i2c0.h"
+#include "geckonator/i2c_slave.h"
+
+#define I2C_SLAVE_FLAGS \
+	( I2C_IEN_ADDR \
+	| I2C_IEN_RXDATAV \
+	| I2C_IEN_TXBL)
+
+enum i2c_slave_state {
+	I2C_SLAVE_POINTER,
+	I2C_SLAVE_WRITE,
+	I2C_SLAVE_READ,
+};
+
+static struct {
+	uint8_t *regs;
+	size_t size;
+	void (*written)(uint8_t reg, uint8_t v);
+	void (*read)(uint8_t reg);
+	enum i2c_slave_state state;
+	uint8_t ptr;
+} i2c_slave;
+
+static inline uint8_t
+i2c_slave_next(uint8_t reg)
+{
+	return (reg + 1U < i2c_slave.size) ? reg + 1U : 0;
+}
+
+/* TXDATA holds the register at the pointer */
+static inline void
+i2c_slave_preload(void)
+{
+	i2c0_clear_tx();
+	i2c0_txdata(i2c_slave.regs[i2c_slave.ptr]);
+}
+
+void
+I2C0_IRQHandler(void)
+{
+	uint32_t flags = i2c0_flags();
+
+#ifdef I2C_SLAVE_TRACE
+	gpio_set(I2C_SLAVE_TRACE);
+#endif
+	i2c0_flags_clear(flags);
+
+	if (i2c0_flag_address(flags)) {
+		if (i2c0_rxdata() & 1U) {
+			/* regs[] may have changed since it was preloaded */
+			i2c_slave.state = I2C_SLAVE_READ;
+			i2c_slave_preload();
+		} else
+			i2c_slave.state = I2C_SLAVE_POINTER;
+	}
+
+	if (i2c_slave.state == I2C_SLAVE_READ) {
+		if (i2c0_tx_buffer_level()) {
+			uint8_t reg = i2c_slave.ptr;
+
+			i2c_slave.ptr = i2c_slave_next(reg);
+			i2c0_txdata(i2c_slave.regs[i2c_slave.ptr]);
+			if (i2c_slave.read)
+				i2c_slave.read(reg);
+		}
+	} else {
+		while (i2c0_rxdata_valid()) {
+			uint8_t v = i2c0_rxdata();
+
+			if (i2c_slave.state == I2C_SLAVE_POINTER) {
+				i2c_slave.ptr = (v < i2c_slave.size) ? v : 0;
+				i2c_slave.state = I2C_SLAVE_WRITE;
+			} else {
+				uint8_t reg = i2c_slave.ptr;
+
+				i2c_slave.regs[reg] = v;
+				i2c_slave.ptr = i2c_slave_next(reg);
+				if (i2c_slave.written)
+					i2c_slave.written(reg, v);
+			}
+			i2c_slave_preload();
+		}
+	}
+
+#ifdef I2C_SLAVE_TRACE
+	gpio_clear(I2C_SLAVE_TRACE);
+#endif
+}
+
+int
+i2c_slave_init(uint32_t pins, uint8_t address,
+		uint8_t *regs, size_t size,
+		void (*written)(uint8_t reg, uint8_t v),
+		void (*read)(uint8_t reg))
+{
+	if (size == 0)
+		return -1;
+
+	i2c_slave.regs = regs;
+	i2c_slave.size = size > 256 ? 256 : size;
+	i2c_slave.written = written;
+	i2c_slave.read = read;
+	i2c_slave.state = I2C_SLAVE_POINTER;
+	i2c_slave.ptr = 0;
+
+	i2c0_config(I2C_CTRL_EN | I2C_CTRL_SLAVE | I2C_CTRL_AUTOACK);
+	i2c0_slave_address_set((uint32_t)address << 1);
+	i2c0_slave_address_mask_set(0x7FU << 1);
+	i2c0_pins(pins);
+
+	i2c_slave_preload();
+	i2c0_flags_clear_all();
+	i2c0_flags_enable(I2C_SLAVE_FLAGS);
+	NVIC_EnableIRQ(I2C0_IRQn);
+	return 0;
+}
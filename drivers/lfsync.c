@@ -0,0 +1,140 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "geckonator/lfsync.h"
+
+/* REGFREEZE is bit 0 in all of them */
+#define LFSYNC_FREEZE 1U
+#define LFSYNC_UPDATE 0U
+
+static const struct {
+	volatile uint32_t *freeze;
+	volatile const uint32_t *syncbusy;
+} lfsync_regs[LFSYNC_DOMAINS] = {
+	[LFSYNC_CMU]     = { &CMU->FREEZE,     &CMU->SYNCBUSY },
+	[LFSYNC_RTC]     = { &RTC->FREEZE,     &RTC->SYNCBUSY },
+	[LFSYNC_LEUART0] = { &LEUART0->FREEZE, &LEUART0->SYNCBUSY },
+};
+
+static struct {
+	struct {
+		volatile uint32_t *reg;
+		uint32_t v;
+	} queue[LFSYNC_QUEUE];
+	unsigned int len;
+	bool committed;
+	bool inflight;
+	void (*done)(void);
+	void (*inflight_done)(void);
+} lfsync[LFSYNC_DOMAINS];
+
+/* interrupts disabled */
+static void
+lfsync_start(enum lfsync_domain d)
+{
+	unsigned int i;
+
+	if (!lfsync[d].committed || lfsync[d].inflight ||
+			*lfsync_regs[d].syncbusy)
+		return;
+
+	*lfsync_regs[d].freeze = LFSYNC_FREEZE;
+	for (i = 0; i < lfsync[d].len; i++)
+		*lfsync[d].queue[i].reg = lfsync[d].queue[i].v;
+	*lfsync_regs[d].freeze = LFSYNC_UPDATE;
+
+	lfsync[d].len = 0;
+	lfsync[d].committed = false;
+	lfsync[d].inflight = true;
+	lfsync[d].inflight_done = lfsync[d].done;
+}
+
+/* joins the batch waiting to start, if one is committed */
+int
+lfsync_write(enum lfsync_domain d, volatile uint32_t *reg, uint32_t v)
+{
+	uint32_t primask = irq_save();
+	unsigned int i;
+	int ret = 0;
+
+	for (i = 0; i < lfsync[d].len; i++) {
+		if (lfsync[d].queue[i].reg == reg)
+			break;
+	}
+
+	if (i < lfsync[d].len) {
+		lfsync[d].queue[i].v = v;
+	} else if (i < LFSYNC_QUEUE) {
+		lfsync[d].queue[i].reg = reg;
+		lfsync[d].queue[i].v = v;
+		lfsync[d].len++;
+	} else
+		ret = -1;
+
+	irq_restore(primask);
+	return ret;
+}
+
+int
+lfsync_commit(enum lfsync_domain d, void (*done)(void))
+{
+	uint32_t primask = irq_save();
+	int ret = -1;
+
+	if (!lfsync[d].committed) {
+		lfsync[d].committed = true;
+		lfsync[d].done = done;
+		lfsync_start(d);
+		ret = 0;
+	}
+
+	irq_restore(primask);
+	return ret;
+}
+
+void
+lfsync_poll(void)
+{
+	enum lfsync_domain d;
+
+	for (d = 0; d < LFSYNC_DOMAINS; d++) {
+		void (*done)(void) = NULL;
+		uint32_t primask;
+
+		if (!lfsync[d].inflight && !lfsync[d].committed)
+			continue;
+
+		primask = irq_save();
+		if (lfsync[d].inflight && !*lfsync_regs[d].syncbusy) {
+			lfsync[d].inflight = false;
+			done = lfsync[d].inflight_done;
+		}
+		lfsync_start(d);
+		irq_restore(primask);
+
+		if (done)
+			done();
+	}
+}
+
+uint32_t
+lfsync_busy(enum lfsync_domain d)
+{
+	return lfsync[d].inflight || lfsync[d].committed;
+}
@@ -0,0 +1,139 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/clock.h"
+#include "geckonator/emu.h"
+#include "geckonator/flash.h"
+#include "geckonator/clocktree.h"
+#include "geckonator/perf.h"
+#include "geckonator/osc.h"
+
+static struct {
+	void (*ready[OSC_COUNT])(enum osc o);
+	uint8_t sel[OSC_COUNT];
+	volatile uint8_t pending[OSC_COUNT];
+} osc;
+
+static void
+osc_select(enum osc o)
+{
+	uint32_t sel = osc.sel[o];
+
+	if (o == OSC_HFXO) {
+		if (!(sel & OSC_SEL_HFCLK))
+			return;
+		if (clocktree_osc(CLOCKTREE_HFXO) > PERF_FLASH_0WS_HZ) {
+			flash_read_mode_1ws();
+			clock_hfclk_select_hfxo();
+		} else {
+			clock_hfclk_select_hfxo();
+			flash_read_mode_0ws();
+		}
+		return;
+	}
+
+	if (sel & OSC_SEL_HFCLK)
+		clock_hfclk_select_lfxo();
+	if (sel & OSC_SEL_LFA)
+		clock_lfa_select_lfxo();
+	if (sel & OSC_SEL_LFB)
+		clock_lfb_select_lfxo();
+	if (sel & OSC_SEL_LFC)
+		clock_lfc_select_lfxo();
+}
+
+static void
+osc_done(enum osc o)
+{
+	void (*ready)(enum osc o) = osc.ready[o];
+
+	osc_select(o);
+	osc.ready[o] = NULL;
+	osc.pending[o] = 0;
+	if (ready)
+		ready(o);
+}
+
+void
+CMU_IRQHandler(void)
+{
+	uint32_t flags = clock_flags() & clock_flags_enabled();
+
+	clock_flags_clear(flags);
+	if (clock_flag_hfxo_ready(flags)) {
+		clock_flag_hfxo_ready_disable();
+		osc_done(OSC_HFXO);
+	}
+	if (clock_flag_lfxo_ready(flags)) {
+		clock_flag_lfxo_ready_disable();
+		osc_done(OSC_LFXO);
+	}
+}
+
+void
+osc_start(enum osc o, uint32_t sel, void (*ready)(enum osc o))
+{
+	uint32_t primask = irq_save();
+
+	osc.sel[o] = sel;
+	osc.ready[o] = ready;
+	osc.pending[o] = 1;
+	NVIC_EnableIRQ(CMU_IRQn);
+	if (o == OSC_HFXO) {
+		clock_flags_clear(CMU_IFC_HFXORDY);
+		clock_flag_hfxo_ready_enable();
+		clock_hfxo_enable();
+		/* already running, so finish in the interrupt all the same */
+		if (clock_hfxo_ready())
+			clock_flags_set(CMU_IFS_HFXORDY);
+	} else {
+		clock_flags_clear(CMU_IFC_LFXORDY);
+		clock_flag_lfxo_ready_enable();
+		clock_lfxo_enable();
+		if (clock_lfxo_ready())
+			clock_flags_set(CMU_IFS_LFXORDY);
+	}
+	irq_restore(primask);
+}
+
+uint32_t
+osc_ready(enum osc o)
+{
+	if (o == OSC_HFXO)
+		return clock_hfxo_ready();
+	return clock_lfxo_ready();
+}
+
+void
+osc_wait(enum osc o)
+{
+	uint32_t deep = SCB->SCR & SCB_SCR_SLEEPDEEP_Msk;
+	uint32_t primask;
+
+	emu_deep_sleep_disable();
+	for (;;) {
+		primask = irq_save();
+		if (!osc.pending[o])
+			break;
+		/* a pending interrupt wakes this up, even masked */
+		__WFI();
+		irq_restore(primask);
+	}
+	irq_restore(primask);
+	if (deep)
+		emu_deep_sleep_enable();
+}
@@ -0,0 +1,229 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/clock.h"
+#include "geckonator/devinfo.h"
+#include "geckonator/flash.h"
+#include "geckonator/clocktree.h"
+#include "geckonator/perf.h"
+
+static struct {
+	struct perf_client *clients;
+	uint8_t clock[PERF_LEVELS];
+	uint8_t level;
+	uint8_t osc;           /* the oscillator held for HFCLK */
+} perf = {
+	.clock = {
+		[PERF_LOW] = PERF_HFRCO_1MHZ,
+		[PERF_MID] = PERF_HFRCO_7MHZ,
+		[PERF_MAX] = PERF_HFRCO_21MHZ,
+	},
+	.level = PERF_LEVELS,
+	.osc = CLOCKTREE_OSCS,
+};
+
+/* HFCLK once running from clock, before any HFCLK divider */
+static uint32_t
+perf_clock_hz(enum perf_clock clock)
+{
+	uint32_t hz;
+
+	switch (clock) {
+	case PERF_HFXO:
+		return clocktree_osc(CLOCKTREE_HFXO);
+	case PERF_USHFRCO:
+		hz = clocktree_osc(CLOCKTREE_USHFRCO);
+		if (!(CMU->USHFRCOCONF & CMU_USHFRCOCONF_USHFRCODIV2DIS))
+			hz >>= 1;
+		return hz;
+	case PERF_LFRCO:
+		return clocktree_osc(CLOCKTREE_LFRCO);
+	default:
+		/* the fastest the HFRCO can be in that band */
+		return (clock == PERF_HFRCO_21MHZ) ? 25000000 : 16000000;
+	}
+}
+
+static enum clocktree_osc
+perf_clock_osc(enum perf_clock clock)
+{
+	switch (clock) {
+	case PERF_HFXO:
+		return CLOCKTREE_HFXO;
+	case PERF_USHFRCO:
+		return CLOCKTREE_USHFRCO;
+	case PERF_LFRCO:
+		return CLOCKTREE_LFRCO;
+	default:
+		return CLOCKTREE_HFRCO;
+	}
+}
+
+/* what HFCLK runs from before the first perf_level_set() */
+static enum clocktree_osc
+perf_hfclk_osc(void)
+{
+	if (clock_hfxo_selected())
+		return CLOCKTREE_HFXO;
+	if (clock_ushfrco_selected())
+		return CLOCKTREE_USHFRCO;
+	if (clock_lfrco_selected())
+		return CLOCKTREE_LFRCO;
+	if (clock_lfxo_selected())
+		return CLOCKTREE_LFXO;
+	return CLOCKTREE_HFRCO;
+}
+
+static void
+perf_clock_wait(enum perf_clock clock)
+{
+	switch (clock) {
+	case PERF_HFXO:
+		while (!clock_hfxo_ready())
+			/* wait */;
+		break;
+	case PERF_USHFRCO:
+		while (!clock_ushfrco_ready())
+			/* wait */;
+		break;
+	case PERF_LFRCO:
+		while (!clock_lfrco_ready())
+			/* wait */;
+		break;
+	default:
+		while (!clock_hfrco_ready())
+			/* wait */;
+		break;
+	}
+}
+
+static void
+perf_clock_select(enum perf_clock clock)
+{
+	switch (clock) {
+	case PERF_HFXO:
+		clock_hfclk_select_hfxo();
+		break;
+	case PERF_USHFRCO:
+		clock_hfclk_select_ushfrco();
+		break;
+	case PERF_LFRCO:
+		clock_hfclk_select_lfrco();
+		break;
+	default:
+		devinfo_hfrco_band_set(clock << _CMU_HFRCOCTRL_BAND_SHIFT);
+		if (!clock_hfrco_selected())
+			clock_hfclk_select_hfrco();
+		break;
+	}
+}
+
+static void
+perf_clients_call(enum perf_phase phase)
+{
+	struct perf_client *c;
+
+	for (c = perf.clients; c; c = c->next)
+		c->fn(c, phase);
+}
+
+void
+perf_level_define(enum perf_level level, enum perf_clock clock)
+{
+	perf.clock[level] = clock;
+}
+
+int
+perf_level_set(enum perf_level level)
+{
+	enum perf_clock clock;
+	enum clocktree_osc osc;
+	enum clocktree_osc prev;
+	uint32_t primask;
+	int fast;
+
+	if (level >= PERF_LEVELS)
+		return -1;
+	if (level == perf.level)
+		return 0;
+
+	clock = perf.clock[level];
+	osc = perf_clock_osc(clock);
+	fast = perf_clock_hz(clock) > PERF_FLASH_0WS_HZ;
+
+	if (perf.osc == CLOCKTREE_OSCS) {
+		/* take over the clock HFCLK was started from */
+		perf.osc = perf_hfclk_osc();
+		clocktree_osc_get(perf.osc);
+		clocktree_osc_adopt(perf.osc);
+	}
+	clocktree_osc_get(osc);
+	perf_clock_wait(clock);
+
+	perf_clients_call(PERF_BEFORE);
+
+	primask = irq_save();
+	/* an HFRCO band change is best made while something else runs */
+	if (clock <= PERF_HFRCO_21MHZ && !clock_hfrco_selected())
+		devinfo_hfrco_band_set(clock << _CMU_HFRCOCTRL_BAND_SHIFT);
+	if (fast)
+		flash_read_mode_1ws();
+	perf_clock_select(clock);
+	if (!fast)
+		flash_read_mode_0ws();
+	perf.level = level;
+	prev = perf.osc;
+	perf.osc = osc;
+	perf_clients_call(PERF_AFTER);
+	irq_restore(primask);
+
+	/* only turned off if no other level or driver still uses it */
+	clocktree_osc_put(prev);
+	return 0;
+}
+
+/* PERF_LEVELS until the first perf_level_set() */
+enum perf_level
+perf_level(void)
+{
+	return perf.level;
+}
+
+void
+perf_client_add(struct perf_client *c)
+{
+	uint32_t primask = irq_save();
+
+	c->next = perf.clients;
+	perf.clients = c;
+	irq_restore(primask);
+}
+
+void
+perf_client_remove(struct perf_client *c)
+{
+	uint32_t primask = irq_save();
+	struct perf_client **p;
+
+	for (p = &perf.clients; *p; p = &(*p)->next) {
+		if (*p == c) {
+			*p = c->next;
+			break;
+		}
+	}
+	irq_restore(primask);
+}
@@ -0,0 +1,112 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/pulse.h"
+
+#if PULSE_TIMER == 2
+#include "geckonator/timer2.h"
+#define pulse_timer_(name, ...) timer2_##name(__VA_ARGS__)
+#define PULSE_IRQn          TIMER2_IRQn
+#define PULSE_IRQHandler    TIMER2_IRQHandler
+#elif PULSE_TIMER == 1
+#include "geckonator/timer1.h"
+#define pulse_timer_(name, ...) timer1_##name(__VA_ARGS__)
+#define PULSE_IRQn          TIMER1_IRQn
+#define PULSE_IRQHandler    TIMER1_IRQHandler
+#else
+#include "geckonator/timer0.h"
+#define pulse_timer_(name, ...) timer0_##name(__VA_ARGS__)
+#define PULSE_IRQn          TIMER0_IRQn
+#define PULSE_IRQHandler    TIMER0_IRQHandler
+#endif
+
+static struct {
+	void (*done)(void);
+} pulse;
+
+void
+PULSE_IRQHandler(void)
+{
+	pulse_timer_(flag_overflow_clear);
+	if (pulse.done)
+		pulse.done();
+}
+
+void
+pulse_init(uint32_t trigger, int prs_ch, uint32_t pins,
+		unsigned int shift, void (*done)(void))
+{
+	uint32_t input = (trigger == PULSE_RISING)
+		? TIMER_CC_CONFIG_RISING : TIMER_CC_CONFIG_FALLING;
+
+	if (prs_ch != PULSE_PIN)
+		input |= TIMER_CC_CONFIG_PRS | timer_cc_prs_channel(prs_ch);
+
+	pulse.done = done;
+
+	pulse_timer_(stop);
+	pulse_timer_(flag_overflow_disable);
+	pulse_timer_(config, TIMER_CONFIG_UP
+			| TIMER_CONFIG_ONESHOT
+			| trigger
+			| timer_prescaler(shift));
+	pulse_timer_(counter_set, 0);
+	pulse_timer_(top_max);
+	pulse_timer_(cc_config, 0, TIMER_CC_CONFIG_CAPTURE | input);
+	pulse_timer_(cc_config, 1, TIMER_CC_CONFIG_COMPARE
+			| TIMER_CC_CONFIG_MATCH_SET
+			| TIMER_CC_CONFIG_OVERFLOW_CLEAR);
+	pulse_timer_(cc_value_set, 1, 0xFFFFU);
+	pulse_timer_(pins, pins);
+
+	pulse_timer_(flag_overflow_clear);
+	if (done) {
+		pulse_timer_(flag_overflow_enable);
+		NVIC_EnableIRQ(PULSE_IRQn);
+	}
+}
+
+/*
+ * output goes high delay ticks after the edge and low width ticks
+ * after that. fails while a pulse is under way.
+ */
+int
+pulse_set(uint32_t delay, uint32_t width)
+{
+	if (delay == 0 || width == 0
+			|| delay >= 0x10000U || width > 0x10000U - delay)
+		return -1;
+	if (pulse_timer_(running))
+		return -1;
+
+	pulse_timer_(cc_value_set, 1, delay);
+	pulse_timer_(top_set, delay + width - 1);
+	return 0;
+}
+
+/* start a pulse without an edge, if one isn't already under way */
+void
+pulse_fire(void)
+{
+	pulse_timer_(start);
+}
+
+uint32_t
+pulse_busy(void)
+{
+	return pulse_timer_(running);
+}
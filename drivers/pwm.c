@@ -0,0 +1,215 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/pwm.h"
+
+#if PWM_TIMER == 2
+#include "geckonator/timer2.h"
+#define pwm_timer_(name, ...) timer2_##name(__VA_ARGS__)
+#define PWM_IRQn          TIMER2_IRQn
+#define PWM_IRQHandler    TIMER2_IRQHandler
+#elif PWM_TIMER == 1
+#include "geckonator/timer1.h"
+#define pwm_timer_(name, ...) timer1_##name(__VA_ARGS__)
+#define PWM_IRQn          TIMER1_IRQn
+#define PWM_IRQHandler    TIMER1_IRQHandler
+#else
+#include "geckonator/timer0.h"
+#define pwm_timer_(name, ...) timer0_##name(__VA_ARGS__)
+#define PWM_IRQn          TIMER0_IRQn
+#define PWM_IRQHandler    TIMER0_IRQHandler
+#endif
+
+/* CPU cycles needed to write all compare buffers */
+#define PWM_GUARD_CYCLES 32
+
+static struct {
+	uint32_t hfperclk;
+	uint32_t config;
+	uint32_t span;
+	uint32_t guard;
+	unsigned int shift;
+	uint32_t next[PWM_CHANNELS];  /* waiting for the overflow */
+} pwm;
+
+/* TOP for freq at HFPERCLK/(1 << shift), 0 if it doesn't fit */
+static uint32_t
+pwm_top(uint32_t freq, unsigned int shift)
+{
+	uint32_t d;
+	uint32_t ticks;
+
+	if (pwm.config == PWM_CENTER)
+		shift++;
+	d = freq << shift;
+	ticks = (pwm.hfperclk + d/2) / d;
+
+	if (pwm.config != PWM_CENTER)
+		ticks--;
+	if (ticks < 2 || ticks > 0xFFFFU)
+		return 0;
+	return ticks;
+}
+
+static void
+pwm_top_update(uint32_t top)
+{
+	pwm.span = (pwm.config == PWM_CENTER) ? top : top + 1;
+	pwm.guard = (PWM_GUARD_CYCLES >> pwm.shift) + 1;
+	if (pwm.guard > top / 4)
+		pwm.guard = top / 4;
+}
+
+/*
+ * the compare buffers are loaded at the period boundary, so
+ * they're only written when it can't fall between the first
+ * and the last
+ */
+static uint32_t
+pwm_boundary_clear(void)
+{
+	uint32_t cnt = pwm_timer_(counter);
+
+	return cnt >= pwm.guard && cnt + pwm.guard <= pwm_timer_(top);
+}
+
+static void
+pwm_buffers_set(void)
+{
+	pwm_timer_(cc_buffer_set, 0, pwm.next[0]);
+	pwm_timer_(cc_buffer_set, 1, pwm.next[1]);
+	pwm_timer_(cc_buffer_set, 2, pwm.next[2]);
+}
+
+/* right after the boundary there's a whole period to write them */
+void
+PWM_IRQHandler(void)
+{
+	pwm_timer_(flags_clear, pwm_timer_(flags));
+	pwm_timer_(flag_overflow_disable);
+	pwm_buffers_set();
+}
+
+int
+pwm_init(uint32_t hfperclk, uint32_t freq, uint32_t config, uint32_t pins)
+{
+	unsigned int shift;
+	unsigned int i;
+	uint32_t top = 0;
+
+	if (freq == 0 || freq > (1U << 20))
+		return -1;
+
+	pwm.hfperclk = hfperclk;
+	pwm.config = config;
+
+	for (shift = 0; shift <= 10; shift++) {
+		top = pwm_top(freq, shift);
+		if (top)
+			break;
+	}
+	if (top == 0)
+		return -1;
+
+	pwm.shift = shift;
+	pwm_top_update(top);
+
+	pwm_timer_(stop);
+	pwm_timer_(config, config | timer_prescaler(shift));
+	pwm_timer_(top_set, top);
+	pwm_timer_(counter_set, 0);
+	for (i = 0; i < PWM_CHANNELS; i++) {
+		pwm_timer_(cc_config, i, TIMER_CC_CONFIG_PWM);
+		pwm_timer_(cc_value_set, i, 0);
+	}
+	pwm_timer_(pins, pins);
+	pwm_timer_(flag_overflow_disable);
+	pwm_timer_(flag_overflow_clear);
+	NVIC_EnableIRQ(PWM_IRQn);
+	pwm_timer_(start);
+	return 0;
+}
+
+/*
+ * the new period starts at the next boundary, together with
+ * duty cycles written by pwm_update() before then
+ */
+int
+pwm_frequency_set(uint32_t freq)
+{
+	uint32_t top;
+
+	if (freq == 0 || freq > (1U << 20))
+		return -1;
+
+	top = pwm_top(freq, pwm.shift);
+	if (top == 0)
+		return -1;
+
+	pwm_top_update(top);
+	pwm_timer_(top_buffer_set, top);
+	return 0;
+}
+
+void
+pwm_update(const uint16_t duty[PWM_CHANNELS])
+{
+	uint32_t v0 = (pwm.span * duty[0]) >> 16;
+	uint32_t v1 = (pwm.span * duty[1]) >> 16;
+	uint32_t v2 = (pwm.span * duty[2]) >> 16;
+	uint32_t primask = irq_save();
+
+	pwm.next[0] = v0;
+	pwm.next[1] = v1;
+	pwm.next[2] = v2;
+	if (pwm_boundary_clear()) {
+		pwm_timer_(flag_overflow_disable);
+		pwm_buffers_set();
+	} else {
+		/* too close, leave it to the overflow */
+		pwm_timer_(flag_overflow_clear);
+		pwm_timer_(flag_overflow_enable);
+	}
+	irq_restore(primask);
+}
+
+void
+pwm_duty_set(unsigned int ch, uint16_t duty)
+{
+	/* so a pwm_update() still waiting doesn't undo it */
+	pwm.next[ch] = (pwm.span * duty) >> 16;
+	pwm_timer_(cc_buffer_set, ch, pwm.next[ch]);
+}
+
+#if PWM_TIMER == 0
+/*
+ * config is TIMER_DTI_ENABLE and friends, time from timer_dti_time().
+ * the complementary outputs are routed with TIMER_PINS_CDTIx_ENABLE
+ */
+void
+pwm_dead_time(uint32_t config, uint32_t time)
+{
+	timer0_dti_time(time);
+	timer0_dti_outputs(TIMER_DTOGEN_DTOGCC0EN
+			| TIMER_DTOGEN_DTOGCC1EN
+			| TIMER_DTOGEN_DTOGCC2EN
+			| TIMER_DTOGEN_DTOGCDTI0EN
+			| TIMER_DTOGEN_DTOGCDTI1EN
+			| TIMER_DTOGEN_DTOGCDTI2EN);
+	timer0_dti_config(config);
+}
+#endif
@@ -0,0 +1,154 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/qdec.h"
+
+#if QDEC_TIMER == 2
+#include "geckonator/timer2.h"
+#define qdec_timer_(name, ...) timer2_##name(__VA_ARGS__)
+#define QDEC_IRQn          TIMER2_IRQn
+#define QDEC_IRQHandler    TIMER2_IRQHandler
+#elif QDEC_TIMER == 1
+#include "geckonator/timer1.h"
+#define qdec_timer_(name, ...) timer1_##name(__VA_ARGS__)
+#define QDEC_IRQn          TIMER1_IRQn
+#define QDEC_IRQHandler    TIMER1_IRQHandler
+#else
+#include "geckonator/timer0.h"
+#define qdec_timer_(name, ...) timer0_##name(__VA_ARGS__)
+#define QDEC_IRQn          TIMER0_IRQn
+#define QDEC_IRQHandler    TIMER0_IRQHandler
+#endif
+
+static struct {
+	void (*sample)(int32_t velocity);
+	volatile uint32_t wraps;
+	volatile int32_t velocity;
+	uint32_t last;
+	uint32_t prev;
+	int primed;
+} qdec;
+
+/* position of cnt, given the wraps counted and those still pending */
+static uint32_t
+qdec_extend(uint32_t wraps, uint32_t cnt, uint32_t flags)
+{
+	uint32_t of = qdec_timer_(flag_overflow, flags);
+	uint32_t uf = qdec_timer_(flag_underflow, flags);
+	uint32_t pos = wraps << 16 | cnt;
+
+	if (of && uf) {
+		/* wrapped both ways, so it can't have gone far from the last */
+		pos = qdec.last + (int16_t)(cnt - (qdec.last & 0xFFFFU));
+	} else if (of && cnt < 0x8000U) {
+		pos += 0x10000U;
+	} else if (uf && cnt >= 0x8000U) {
+		pos -= 0x10000U;
+	}
+	return pos;
+}
+
+int32_t
+qdec_position(void)
+{
+	uint32_t wraps;
+	uint32_t cnt;
+	uint32_t flags;
+
+	do {
+		wraps = qdec.wraps;
+		cnt = qdec_timer_(counter);
+		flags = qdec_timer_(flags);
+	} while (wraps != qdec.wraps);
+
+	return qdec_extend(wraps, cnt,
+			flags & (TIMER_IF_OF | TIMER_IF_UF));
+}
+
+int32_t
+qdec_velocity(void)
+{
+	return qdec.velocity;
+}
+
+void
+QDEC_IRQHandler(void)
+{
+	uint32_t flags = qdec_timer_(flags);
+	uint32_t of = qdec_timer_(flag_overflow, flags);
+	uint32_t uf = qdec_timer_(flag_underflow, flags);
+	uint32_t pos;
+
+	qdec_timer_(flags_clear, flags);
+
+	if (of && uf)
+		qdec.wraps = qdec_extend(qdec.wraps, qdec_timer_(counter),
+				flags & (TIMER_IF_OF | TIMER_IF_UF)) >> 16;
+	else if (of)
+		qdec.wraps++;
+	else if (uf)
+		qdec.wraps--;
+
+	pos = qdec_position();
+	qdec.last = pos;
+
+	/* the capture was taken less than half a wrap ago */
+	while (qdec_timer_(cc2_capture_valid)) {
+		uint32_t c = qdec_timer_(cc_value, 2);
+		uint32_t at = pos + (int16_t)(c - (pos & 0xFFFFU));
+
+		if (qdec.primed) {
+			qdec.velocity = (int32_t)(at - qdec.prev);
+			if (qdec.sample)
+				qdec.sample(qdec.velocity);
+		}
+		qdec.prev = at;
+		qdec.primed = 1;
+	}
+}
+
+/* config is TIMER_CONFIG_QDEC_X2 or _X4 */
+void
+qdec_init(uint32_t config, uint32_t pins, int gate_prs_ch,
+		void (*sample)(int32_t velocity))
+{
+	qdec.sample = sample;
+	qdec.wraps = 0;
+	qdec.velocity = 0;
+	qdec.last = 0;
+	qdec.primed = 0;
+
+	qdec_timer_(stop);
+	qdec_timer_(config, config);
+	qdec_timer_(top_max);
+	qdec_timer_(counter_set, 0);
+	qdec_timer_(pins, pins);
+	qdec_timer_(flags_clear, _TIMER_IFC_MASK);
+	qdec_timer_(flag_overflow_enable);
+	qdec_timer_(flag_underflow_enable);
+
+	if (gate_prs_ch != QDEC_NONE) {
+		qdec_timer_(cc_config, 2, TIMER_CC_CONFIG_CAPTURE
+				| TIMER_CC_CONFIG_PRS
+				| TIMER_CC_CONFIG_RISING
+				| timer_cc_prs_channel(gate_prs_ch));
+		qdec_timer_(flag_cc2_enable);
+	}
+
+	NVIC_EnableIRQ(QDEC_IRQn);
+	qdec_timer_(start);
+}
@@ -0,0 +1,275 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "geckonator/dma.h"
+#include "geckonator/rs485.h"
+
+#if RS485_USART == 0
+#include "geckonator/usart0.h"
+#define RS485_USARTn          USART0
+#define rs485_usart_(name, ...) usart0_##name(__VA_ARGS__)
+#define RS485_DMAREQ_RX       DMAREQ_USART0_RXDATAV
+#define RS485_DMAREQ_TX       DMAREQ_USART0_TXBL
+#define RS485_RX_IRQn         USART0_RX_IRQn
+#define RS485_TX_IRQn         USART0_TX_IRQn
+#define RS485_RX_IRQHandler   USART0_RX_IRQHandler
+#define RS485_TX_IRQHandler   USART0_TX_IRQHandler
+#else
+#include "geckonator/usart1.h"
+#define RS485_USARTn          USART1
+#define rs485_usart_(name, ...) usart1_##name(__VA_ARGS__)
+#define RS485_DMAREQ_RX       DMAREQ_USART1_RXDATAV
+#define RS485_DMAREQ_TX       DMAREQ_USART1_TXBL
+#define RS485_RX_IRQn         USART1_RX_IRQn
+#define RS485_TX_IRQn         USART1_TX_IRQn
+#define RS485_RX_IRQHandler   USART1_RX_IRQHandler
+#define RS485_TX_IRQHandler   USART1_TX_IRQHandler
+#endif
+
+#define RS485_DMA_RX \
+	( DMA_CTRL_DST_INC_BYTE \
+	| DMA_CTRL_DST_SIZE_BYTE \
+	| DMA_CTRL_SRC_INC_NONE \
+	| DMA_CTRL_SRC_SIZE_BYTE \
+	| DMA_CTRL_R_POWER_1 \
+	| DMA_CTRL_CYCLE_CTRL_BASIC)
+#define RS485_DMA_TX \
+	( DMA_CTRL_DST_INC_NONE \
+	| DMA_CTRL_DST_SIZE_BYTE \
+	| DMA_CTRL_SRC_INC_BYTE \
+	| DMA_CTRL_SRC_SIZE_BYTE \
+	| DMA_CTRL_R_POWER_1 \
+	| DMA_CTRL_CYCLE_CTRL_BASIC)
+
+enum rs485_state {
+	RS485_IDLE,
+	RS485_LENGTH,
+	RS485_DATA,
+};
+
+static struct {
+	uint8_t *buf;
+	size_t size;
+	size_t len;
+	void (*received)(uint8_t *buf, size_t len);
+	void (*sent)(void);
+	enum rs485_state state;
+	volatile bool sending;
+	bool autotri;
+	uint8_t address;
+	gpio_pin_t de;
+	unsigned int rx_ch;
+	unsigned int tx_ch;
+} rs485;
+
+static void
+rs485_rx_done(void)
+{
+	rs485.state = RS485_IDLE;
+	rs485_usart_(rx_block_enable);
+	if (rs485.received)
+		rs485.received(rs485.buf, rs485.len);
+}
+
+static void
+rs485_tx_done(void)
+{
+	if (!rs485.autotri)
+		gpio_clear(rs485.de);
+	rs485.sending = false;
+	if (rs485.sent)
+		rs485.sent();
+}
+
+static void
+rs485_dma_rx_handler(unsigned int ch)
+{
+	rs485_rx_done();
+}
+
+static void
+rs485_dma_tx_handler(unsigned int ch)
+{
+	/* the last byte is still being shifted out */
+	rs485_usart_(flag_tx_complete_clear);
+	if (rs485_usart_(tx_complete))
+		rs485_tx_done();
+	else
+		rs485_usart_(flag_tx_complete_enable);
+}
+
+void
+RS485_RX_IRQHandler(void)
+{
+	uint32_t flags = rs485_usart_(flags);
+
+	rs485_usart_(flags_clear, flags);
+
+	if (rs485_usart_(flag_mp_address, flags)) {
+		uint8_t address = rs485_usart_(rxdatax);
+
+		/* drop a packet cut short by a new address frame */
+		dma_channel_disable(rs485.rx_ch);
+
+		if (rs485.buf && (address == rs485.address ||
+					address == RS485_BROADCAST)) {
+			rs485.state = RS485_LENGTH;
+			rs485_usart_(rx_block_disable);
+			rs485_usart_(flag_rx_valid_enable);
+		} else {
+			rs485.state = RS485_IDLE;
+			rs485_usart_(rx_block_enable);
+			return;
+		}
+	}
+
+	if (rs485.state == RS485_LENGTH && rs485_usart_(rx_valid)) {
+		struct dma_descriptor *d = dma_primary(rs485.rx_ch);
+		size_t len = rs485_usart_(rxdata);
+
+		rs485_usart_(flag_rx_valid_disable);
+
+		if (len > rs485.size) {
+			rs485.state = RS485_IDLE;
+			rs485_usart_(rx_block_enable);
+			return;
+		}
+
+		rs485.len = len;
+		if (len == 0) {
+			rs485_rx_done();
+			return;
+		}
+
+		rs485.state = RS485_DATA;
+		d->dst_end = &rs485.buf[len - 1];
+		d->control = RS485_DMA_RX | (len - 1) << _DMA_CTRL_N_MINUS_1_SHIFT;
+		dma_channel_enable(rs485.rx_ch);
+	}
+}
+
+void
+RS485_TX_IRQHandler(void)
+{
+	rs485_usart_(flag_tx_complete_disable);
+	rs485_usart_(flag_tx_complete_clear);
+	rs485_tx_done();
+}
+
+void
+rs485_init(uint32_t pins, uint32_t clkdiv, uint32_t config,
+		gpio_pin_t de, unsigned int rx_ch, unsigned int tx_ch)
+{
+	rs485.de = de;
+	rs485.autotri = config & RS485_CONFIG_AUTOTRI;
+	rs485.rx_ch = rx_ch;
+	rs485.tx_ch = tx_ch;
+
+	rs485_usart_(rxtx_disable);
+	rs485_usart_(config, USART_CTRL_MPM | USART_CTRL_MPAB | config);
+	rs485_usart_(frame_9n1);
+	rs485_usart_(clock_div, clkdiv);
+	rs485_usart_(pins, pins);
+	rs485_usart_(rx_clear);
+	rs485_usart_(tx_clear);
+	rs485_usart_(flags_clear_all);
+
+	if (!rs485.autotri) {
+		gpio_clear(de);
+		gpio_mode(de, GPIO_MODE_PUSHPULL);
+	}
+
+	dma_primary(rx_ch)->src_end = (volatile void *)&RS485_USARTn->RXDATA;
+	dma_channel_config(rx_ch, RS485_DMAREQ_RX);
+	dma_channel_handler_set(rx_ch, rs485_dma_rx_handler);
+	dma_flag_done_clear(rx_ch);
+	dma_flag_done_enable(rx_ch);
+
+	dma_primary(tx_ch)->dst_end = &RS485_USARTn->TXDATA;
+	dma_channel_config(tx_ch, RS485_DMAREQ_TX);
+	dma_channel_handler_set(tx_ch, rs485_dma_tx_handler);
+	dma_flag_done_clear(tx_ch);
+	dma_flag_done_enable(tx_ch);
+
+	rs485_usart_(flag_mp_address_enable);
+	NVIC_EnableIRQ(DMA_IRQn);
+	NVIC_EnableIRQ(RS485_RX_IRQn);
+	NVIC_EnableIRQ(RS485_TX_IRQn);
+
+	rs485_usart_(rx_block_enable);
+	rs485_usart_(rxtx_enable);
+}
+
+void
+rs485_address_set(uint8_t address)
+{
+	rs485.address = address;
+}
+
+/*
+ * the buffer is used for every packet received from now on.
+ * done is called from interrupt context and the buffer is
+ * overwritten by the next packet once it returns.
+ */
+void
+rs485_receive(uint8_t *buf, size_t size,
+		void (*done)(uint8_t *buf, size_t len))
+{
+	NVIC_DisableIRQ(RS485_RX_IRQn);
+	rs485.buf = buf;
+	rs485.size = size;
+	rs485.received = done;
+	NVIC_EnableIRQ(RS485_RX_IRQn);
+}
+
+int
+rs485_send(uint8_t address, const uint8_t *data, size_t len,
+		void (*done)(void))
+{
+	struct dma_descriptor *d = dma_primary(rs485.tx_ch);
+
+	if (rs485.sending || len > 255)
+		return -1;
+
+	rs485.sending = true;
+	rs485.sent = done;
+
+	if (!rs485.autotri)
+		gpio_set(rs485.de);
+
+	/* the TX buffer holds both the address and length frames */
+	rs485_usart_(txdatax, 0x100U | address);
+	rs485_usart_(txdata, len);
+
+	if (len == 0) {
+		rs485_dma_tx_handler(rs485.tx_ch);
+		return 0;
+	}
+
+	d->src_end = (void *)&data[len - 1];
+	d->control = RS485_DMA_TX | (len - 1) << _DMA_CTRL_N_MINUS_1_SHIFT;
+	dma_channel_enable(rs485.tx_ch);
+	return 0;
+}
+
+uint32_t
+rs485_sending(void)
+{
+	return rs485.sending;
+}
@@ -0,0 +1,352 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "geckonator/rtc.h"
+#include "geckonator/lfsync.h"
+#include "geckonator/swtimer.h"
+
+#define SWTIMER_BITS   5
+#define SWTIMER_SLOTS  (1U << SWTIMER_BITS)
+#define SWTIMER_LEVELS 4
+#define SWTIMER_FAR    (SWTIMER_LEVELS * SWTIMER_SLOTS)
+#define SWTIMER_RANGE  (1U << (SWTIMER_LEVELS * SWTIMER_BITS))
+
+/* COMP0 can't be relied on to match this close to a deadline */
+#define SWTIMER_MARGIN 3
+
+static struct {
+	volatile uint32_t epoch;  /* half RTC periods */
+	uint32_t base;            /* everything before this has run */
+	uint32_t armed;
+	bool armed_valid;
+	uint32_t map[SWTIMER_LEVELS];
+	struct swtimer *slot[SWTIMER_FAR + 1];
+} swtimer;
+
+uint32_t
+swtimer_now(void)
+{
+	uint32_t epoch;
+	uint32_t cnt;
+
+	do {
+		epoch = swtimer.epoch;
+		cnt = rtc_counter();
+	} while (epoch != swtimer.epoch);
+
+	/* the interrupt for the half just entered is still pending */
+	if ((epoch ^ (cnt >> 23)) & 1)
+		epoch++;
+
+	return (epoch & ~1U) << 23 | cnt;
+}
+
+static void
+swtimer_link(struct swtimer *t, unsigned int index)
+{
+	struct swtimer **head = &swtimer.slot[index];
+
+	t->index = index;
+	t->next = *head;
+	if (t->next)
+		t->next->pprev = &t->next;
+	t->pprev = head;
+	*head = t;
+
+	if (index < SWTIMER_FAR)
+		swtimer.map[index / SWTIMER_SLOTS] |= 1U << (index % SWTIMER_SLOTS);
+}
+
+static void
+swtimer_unlink(struct swtimer *t)
+{
+	unsigned int index = t->index;
+
+	*t->pprev = t->next;
+	if (t->next)
+		t->next->pprev = t->pprev;
+	t->pprev = NULL;
+
+	if (index < SWTIMER_FAR && swtimer.slot[index] == NULL)
+		swtimer.map[index / SWTIMER_SLOTS] &= ~(1U << (index % SWTIMER_SLOTS));
+}
+
+/*
+ * a timer goes on the lowest level where it shares all higher bits
+ * with the base, in the slot given by its bits at that level. as the
+ * base reaches the start of that slot it moves down a level
+ */
+static void
+swtimer_insert(struct swtimer *t)
+{
+	uint32_t e = t->expires;
+	uint32_t x;
+	unsigned int level;
+
+	if ((int32_t)(e - swtimer.base) < 0)
+		e = swtimer.base;
+
+	x = e ^ swtimer.base;
+	if (x >= SWTIMER_RANGE) {
+		swtimer_link(t, SWTIMER_FAR);
+		return;
+	}
+
+	for (level = 0; x >= SWTIMER_SLOTS; level++)
+		x >>= SWTIMER_BITS;
+
+	swtimer_link(t, level * SWTIMER_SLOTS
+			+ ((e >> (level * SWTIMER_BITS)) & (SWTIMER_SLOTS - 1)));
+}
+
+/* the next time a timer runs or moves down a level */
+static bool
+swtimer_next(uint32_t *next)
+{
+	uint32_t base = swtimer.base;
+	uint32_t best = SWTIMER_RANGE;
+	unsigned int level;
+
+	if (swtimer.slot[SWTIMER_FAR])
+		best = SWTIMER_RANGE - (base & (SWTIMER_RANGE - 1));
+
+	for (level = 0; level < SWTIMER_LEVELS; level++) {
+		unsigned int shift = level * SWTIMER_BITS;
+		unsigned int i = (base >> shift) & (SWTIMER_SLOTS - 1);
+		uint32_t m = swtimer.map[level];
+		uint32_t t;
+
+		/* above level 0 the slot of the base itself is already done */
+		if (level > 0)
+			i++;
+		if (i >= SWTIMER_SLOTS)
+			continue;
+		m &= ~0U << i;
+		if (m == 0)
+			continue;
+
+		t = (base & ~((SWTIMER_SLOTS << shift) - 1))
+			| (uint32_t)__builtin_ctz(m) << shift;
+		if (t - base < best)
+			best = t - base;
+	}
+
+	if (best == SWTIMER_RANGE && swtimer.slot[SWTIMER_FAR] == NULL)
+		return false;
+
+	*next = base + best;
+	return true;
+}
+
+static void
+swtimer_cascade(unsigned int index)
+{
+	struct swtimer *t = swtimer.slot[index];
+
+	swtimer.slot[index] = NULL;
+	if (index < SWTIMER_FAR)
+		swtimer.map[index / SWTIMER_SLOTS] &= ~(1U << (index % SWTIMER_SLOTS));
+
+	while (t) {
+		struct swtimer *next = t->next;
+
+		swtimer_insert(t);
+		t = next;
+	}
+}
+
+/* move the base to t and run what's due there */
+static void
+swtimer_advance(uint32_t t, uint32_t primask)
+{
+	struct swtimer **head = &swtimer.slot[t & (SWTIMER_SLOTS - 1)];
+	unsigned int level;
+
+	swtimer.base = t;
+
+	if ((t & (SWTIMER_RANGE - 1)) == 0)
+		swtimer_cascade(SWTIMER_FAR);
+	for (level = SWTIMER_LEVELS - 1; level > 0; level--) {
+		unsigned int shift = level * SWTIMER_BITS;
+
+		if (t & ((1U << shift) - 1))
+			continue;
+		swtimer_cascade(level * SWTIMER_SLOTS
+				+ ((t >> shift) & (SWTIMER_SLOTS - 1)));
+	}
+
+	while (*head) {
+		struct swtimer *e = *head;
+
+		swtimer_unlink(e);
+		if (e->period) {
+			e->expires += e->period;
+			swtimer_insert(e);
+		}
+		irq_restore(primask);
+		e->fn(e);
+		irq_save();
+	}
+}
+
+/*
+ * lfsync done, COMP0 has landed. if that was too late for it to
+ * match, the interrupt is pended once to catch up
+ */
+static void
+swtimer_synced(void)
+{
+	uint32_t primask = irq_save();
+
+	if (swtimer.armed_valid
+			&& (int32_t)(swtimer.armed - swtimer_now()) <= SWTIMER_MARGIN) {
+		swtimer.armed_valid = false;
+		rtc_flag_comp0_set();
+	}
+	irq_restore(primask);
+}
+
+/*
+ * set COMP0 for the next thing to do, at most half the RTC period
+ * ahead. if that's too close to make it, pend the interrupt instead.
+ * the write goes through lfsync, so one made while the previous is
+ * still crossing into the LF domain replaces it rather than waiting
+ */
+static void
+swtimer_arm(void)
+{
+	uint32_t now;
+	uint32_t next;
+
+	if (!swtimer_next(&next)) {
+		swtimer.armed_valid = false;
+		rtc_flag_comp0_disable();
+		return;
+	}
+	if (swtimer.armed_valid && next == swtimer.armed)
+		return;
+
+	now = swtimer_now();
+	if ((int32_t)(next - now) <= SWTIMER_MARGIN) {
+		swtimer.armed_valid = false;
+		rtc_flag_comp0_enable();
+		rtc_flag_comp0_set();
+		return;
+	}
+	if (next - now > (1U << 23))
+		next = now + (1U << 23);
+
+	swtimer.armed = next;
+	swtimer.armed_valid = true;
+	lfsync_write(LFSYNC_RTC, &RTC->COMP0, next & _RTC_CNT_MASK);
+	lfsync_commit(LFSYNC_RTC, swtimer_synced);
+	rtc_flag_comp0_enable();
+}
+
+void
+RTC_IRQHandler(void)
+{
+	uint32_t flags = rtc_flags();
+	uint32_t primask;
+	uint32_t now;
+	uint32_t next;
+
+	rtc_flags_clear(flags);
+	/* let a finished COMP0 write make way for the next one */
+	lfsync_poll();
+	if (rtc_flag_comp1(flags))
+		swtimer.epoch++;
+	if (rtc_flag_overflow(flags))
+		swtimer.epoch++;
+
+	primask = irq_save();
+	swtimer.armed_valid = false;
+	for (;;) {
+		now = swtimer_now();
+		if (!swtimer_next(&next)
+				|| (int32_t)(next - now) > SWTIMER_MARGIN)
+			break;
+		/* too close for COMP0, so run it a little early */
+		swtimer_advance(next, primask);
+	}
+	if ((int32_t)(now - swtimer.base) > 0)
+		swtimer.base = now;
+	swtimer_arm();
+	irq_restore(primask);
+}
+
+void
+swtimer_init(void)
+{
+	unsigned int i;
+
+	swtimer.epoch = 0;
+	swtimer.base = 0;
+	swtimer.armed_valid = false;
+	for (i = 0; i < SWTIMER_LEVELS; i++)
+		swtimer.map[i] = 0;
+	for (i = 0; i <= SWTIMER_FAR; i++)
+		swtimer.slot[i] = NULL;
+
+	/* a second write before SYNCBUSY clears would be lost */
+	while (rtc_syncbusy())
+		/* wait */;
+	rtc_config(0);
+	rtc_flags_clear(RTC_IFC_COMP0 | RTC_IFC_COMP1 | RTC_IFC_OF);
+	rtc_flag_comp1_enable();
+	rtc_flag_overflow_enable();
+	NVIC_EnableIRQ(RTC_IRQn);
+	while (rtc_syncbusy())
+		/* wait */;
+	rtc_freeze();
+	rtc_comp1_set(1U << 23);
+	rtc_config(RTC_ENABLE);
+	rtc_update();
+}
+
+void
+swtimer_at(struct swtimer *t, uint32_t expires)
+{
+	uint32_t primask = irq_save();
+
+	if (t->pprev)
+		swtimer_unlink(t);
+	t->expires = expires;
+	swtimer_insert(t);
+	swtimer_arm();
+	irq_restore(primask);
+}
+
+void
+swtimer_after(struct swtimer *t, uint32_t ticks)
+{
+	swtimer_at(t, swtimer_now() + ticks);
+}
+
+void
+swtimer_cancel(struct swtimer *t)
+{
+	uint32_t primask = irq_save();
+
+	if (t->pprev) {
+		swtimer_unlink(t);
+		swtimer_arm();
+	}
+	irq_restore(primask);
+}
@@ -0,0 +1,156 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/timebase.h"
+
+#if TIMEBASE_TIMER == 2
+#include "geckonator/timer2.h"
+#define timebase_timer_(name, ...) timer2_##name(__VA_ARGS__)
+#define TIMEBASE_IRQn          TIMER2_IRQn
+#define TIMEBASE_IRQHandler    TIMER2_IRQHandler
+#elif TIMEBASE_TIMER == 1
+#include "geckonator/timer1.h"
+#define timebase_timer_(name, ...) timer1_##name(__VA_ARGS__)
+#define TIMEBASE_IRQn          TIMER1_IRQn
+#define TIMEBASE_IRQHandler    TIMER1_IRQHandler
+#else
+#include "geckonator/timer0.h"
+#define timebase_timer_(name, ...) timer0_##name(__VA_ARGS__)
+#define TIMEBASE_IRQn          TIMER0_IRQn
+#define TIMEBASE_IRQHandler    TIMER0_IRQHandler
+#endif
+
+static struct {
+	volatile uint32_t lo;  /* epoch, counting half periods */
+	volatile uint32_t hi;
+	uint32_t us_mul;       /* microseconds per tick << 32 */
+	uint32_t tick_mul;     /* ticks per microsecond << 16 */
+} timebase;
+
+void
+TIMEBASE_IRQHandler(void)
+{
+	uint32_t flags = timebase_timer_(flags);
+	uint32_t lo = timebase.lo;
+	uint32_t hi = timebase.hi;
+	uint32_t primask;
+
+	timebase_timer_(flags_clear, flags);
+
+	/* if held off long enough both are set, and both count */
+	if (timebase_timer_(flag_cc0, flags)) {
+		if (++lo == 0)
+			hi++;
+	}
+	if (timebase_timer_(flag_overflow, flags)) {
+		if (++lo == 0)
+			hi++;
+	}
+
+	/* so a reader at a higher priority never sees hi and lo disagree */
+	primask = irq_save();
+	timebase.lo = lo;
+	timebase.hi = hi;
+	irq_restore(primask);
+}
+
+int
+timebase_init(uint32_t hfperclk, unsigned int shift)
+{
+	uint32_t tick_hz = hfperclk >> shift;
+
+	if (tick_hz < 1000000)
+		return -1;
+
+	timebase.us_mul = ((uint64_t)1000000 << 32) / tick_hz;
+	timebase.tick_mul = ((uint64_t)tick_hz << 16) / 1000000;
+	timebase.lo = 0;
+	timebase.hi = 0;
+
+	timebase_timer_(stop);
+	timebase_timer_(config, TIMER_CTRL_MODE_UP | timer_prescaler(shift));
+	timebase_timer_(top_set, 0xFFFFU);
+	timebase_timer_(counter_set, 0);
+	timebase_timer_(cc_config, 0, TIMER_CC_CONFIG_COMPARE);
+	timebase_timer_(cc_value_set, 0, 0x8000U);
+	timebase_timer_(flags_clear, TIMER_IFC_CC0 | TIMER_IFC_OF);
+	timebase_timer_(flag_cc0_enable);
+	timebase_timer_(flag_overflow_enable);
+	NVIC_EnableIRQ(TIMEBASE_IRQn);
+	timebase_timer_(start);
+	return 0;
+}
+
+/*
+ * the epoch is even in the lower half of the count and odd in the
+ * upper half. when the top bit of the counter disagrees the interrupt
+ * for the half just entered hasn't run yet, so count it here
+ */
+uint64_t
+timebase_ticks(void)
+{
+	uint32_t lo;
+	uint32_t hi;
+	uint32_t cnt;
+
+	do {
+		hi = timebase.hi;
+		lo = timebase.lo;
+		cnt = timebase_timer_(counter);
+	} while (lo != timebase.lo || hi != timebase.hi);
+
+	if ((lo ^ (cnt >> 15)) & 1) {
+		if (++lo == 0)
+			hi++;
+	}
+
+	return ((uint64_t)hi << 47) | (uint64_t)(lo & ~1U) << 15 | cnt;
+}
+
+uint32_t
+timebase_ticks32(void)
+{
+	uint32_t lo;
+	uint32_t cnt;
+
+	do {
+		lo = timebase.lo;
+		cnt = timebase_timer_(counter);
+	} while (lo != timebase.lo);
+
+	if ((lo ^ (cnt >> 15)) & 1)
+		lo++;
+
+	return (lo & ~1U) << 15 | cnt;
+}
+
+/* ticks * us_mul >> 32 in two 32x32 multiplies */
+uint64_t
+timebase_ticks_to_us(uint64_t ticks)
+{
+	uint32_t th = ticks >> 32;
+	uint32_t tl = ticks;
+
+	return (uint64_t)th * timebase.us_mul
+		+ (((uint64_t)tl * timebase.us_mul) >> 32);
+}
+
+uint64_t
+timebase_us_to_ticks(uint32_t us)
+{
+	return ((uint64_t)us * timebase.tick_mul) >> 16;
+}
@@ -0,0 +1,116 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "geckonator/clock.h"
+#include "geckonator/devinfo.h"
+#include "geckonator/usb.h"
+#include "geckonator/swtimer.h"
+#include "geckonator/usbclk.h"
+
+static struct {
+	struct swtimer poll;
+	void (*changed)(uint32_t locked);
+	uint16_t tuning[USBCLK_HISTORY];
+	uint32_t frame;
+	uint8_t seen;
+	uint8_t next;
+	uint8_t locked;
+} usbclk;
+
+/* coarse and fine tuning as one number */
+static uint32_t
+usbclk_tuning(void)
+{
+	return clock_ushfrco_tuning() << 6 | clock_ushfrco_finetuning();
+}
+
+static void
+usbclk_poll_fn(struct swtimer *t)
+{
+	uint32_t frame = usb_frame_number(usb_device_status());
+	uint32_t locked = 0;
+	uint32_t lo, hi;
+	unsigned int i;
+
+	if (frame == usbclk.frame) {
+		/* no start of frame, so nothing to lock to */
+		usbclk.seen = 0;
+	} else {
+		usbclk.frame = frame;
+		usbclk.tuning[usbclk.next] = usbclk_tuning();
+		usbclk.next = (usbclk.next + 1) % USBCLK_HISTORY;
+		if (usbclk.seen < USBCLK_HISTORY)
+			usbclk.seen++;
+	}
+
+	if (usbclk.seen == USBCLK_HISTORY) {
+		lo = hi = usbclk.tuning[0];
+		for (i = 1; i < USBCLK_HISTORY; i++) {
+			if (usbclk.tuning[i] < lo)
+				lo = usbclk.tuning[i];
+			if (usbclk.tuning[i] > hi)
+				hi = usbclk.tuning[i];
+		}
+		locked = (hi - lo <= USBCLK_LOCK_SPREAD);
+	}
+
+	if (locked != usbclk.locked) {
+		usbclk.locked = locked;
+		if (usbclk.changed)
+			usbclk.changed(locked);
+	}
+}
+
+/* poll is in RTC ticks, a few ms or more */
+void
+usbclk_start(uint32_t poll, void (*changed)(uint32_t locked))
+{
+	usbclk.changed = changed;
+	usbclk.seen = 0;
+	usbclk.next = 0;
+	usbclk.locked = 0;
+	usbclk.frame = usb_frame_number(usb_device_status());
+
+	devinfo_ushfrco_band_set(CMU_USHFRCOCONF_BAND_48MHZ);
+	clock_ushfrco_enable();
+	while (!clock_ushfrco_ready())
+		/* wait */;
+	clock_usbc_select_ushfrco();
+	while (!clock_usbc_ushfrco_selected())
+		/* wait */;
+	clock_ushfrco_recovery_enable();
+
+	usbclk.poll.fn = usbclk_poll_fn;
+	usbclk.poll.period = poll;
+	swtimer_after(&usbclk.poll, poll);
+}
+
+void
+usbclk_stop(void)
+{
+	swtimer_cancel(&usbclk.poll);
+	clock_ushfrco_recovery_disable();
+	usbclk.locked = 0;
+}
+
+uint32_t
+usbclk_locked(void)
+{
+	return usbclk.locked;
+}
@@ -0,0 +1,191 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geckonator/dma.h"
+#include "geckonator/wave.h"
+
+#if WAVE_TIMER == 2
+#include "geckonator/timer2.h"
+#define wave_timer_(name, ...) timer2_##name(__VA_ARGS__)
+#define WAVE_DMAREQ            DMAREQ_TIMER2_UFOF
+#elif WAVE_TIMER == 1
+#include "geckonator/timer1.h"
+#define wave_timer_(name, ...) timer1_##name(__VA_ARGS__)
+#define WAVE_DMAREQ            DMAREQ_TIMER1_UFOF
+#else
+#include "geckonator/timer0.h"
+#define wave_timer_(name, ...) timer0_##name(__VA_ARGS__)
+#define WAVE_DMAREQ            DMAREQ_TIMER0_UFOF
+#endif
+
+#define WAVE_DMA \
+	( DMA_CTRL_DST_INC_NONE \
+	| DMA_CTRL_DST_SIZE_WORD \
+	| DMA_CTRL_SRC_INC_WORD \
+	| DMA_CTRL_SRC_SIZE_WORD \
+	| DMA_CTRL_R_POWER_1)
+
+static struct {
+	void (*done)(void);
+	void (*refill)(uint32_t *buf, size_t len);
+	const uint32_t *buf[2];
+	volatile uint32_t *dst;
+	size_t len;
+	uint32_t left;    /* tables still to play, 0 for ever */
+	uint32_t unarmed; /* of those, not yet armed */
+	unsigned int ch;
+	volatile uint32_t busy;
+} wave;
+
+/* the last table is played in basic mode, which ends the cycle there */
+static void
+wave_arm(struct dma_descriptor *d, const uint32_t *buf, int last)
+{
+	d->src_end = (volatile void *)&buf[wave.len - 1];
+	d->dst_end = wave.dst;
+	d->control = WAVE_DMA
+		| (last ? DMA_CTRL_CYCLE_CTRL_BASIC : DMA_CTRL_CYCLE_CTRL_PINGPONG)
+		| (wave.len - 1) << _DMA_CTRL_N_MINUS_1_SHIFT;
+}
+
+static void
+wave_end(void)
+{
+	wave_timer_(stop);
+	dma_channel_disable(wave.ch);
+	wave.busy = 0;
+}
+
+static void
+wave_dma_handler(unsigned int ch)
+{
+	/* the descriptor which just finished is the one not in use now */
+	unsigned int h = dma_channel_alternate(ch) ? 0 : 1;
+	struct dma_descriptor *d = h ? dma_alternate(ch) : dma_primary(ch);
+
+	if (wave.refill) {
+		wave.refill((uint32_t *)wave.buf[h], wave.len);
+		wave_arm(d, wave.buf[h], 0);
+		return;
+	}
+
+	if (wave.left && --wave.left == 0) {
+		wave_end();
+		if (wave.done)
+			wave.done();
+		return;
+	}
+
+	if (wave.left == 0) {
+		wave_arm(d, wave.buf[h], 0);
+	} else if (wave.unarmed) {
+		wave.unarmed--;
+		wave_arm(d, wave.buf[h], wave.unarmed == 0);
+	}
+}
+
+void
+wave_init(unsigned int dma_ch, unsigned int port,
+		enum wave_target target, unsigned int shift, uint32_t top)
+{
+	wave.ch = dma_ch;
+	wave.dst = (target == WAVE_DOUTTGL) ? &GPIO->P[port].DOUTTGL : &GPIO->P[port].DOUT;
+	wave.busy = 0;
+
+	wave_timer_(stop);
+	/* the DMA doesn't touch the TIMER, so clear the request as it runs */
+	wave_timer_(config, TIMER_CONFIG_UP | TIMER_CONFIG_DMACLRACT
+			| timer_prescaler(shift));
+	wave_timer_(top_set, top);
+	wave_timer_(counter_set, 0);
+
+	dma_channel_config(dma_ch, WAVE_DMAREQ);
+	dma_channel_handler_set(dma_ch, wave_dma_handler);
+	dma_flag_done_clear(dma_ch);
+	dma_flag_done_enable(dma_ch);
+	NVIC_EnableIRQ(DMA_IRQn);
+}
+
+static void
+wave_start(void)
+{
+	wave.busy = 1;
+	dma_channel_alternate_disable(wave.ch);
+	dma_channel_enable(wave.ch);
+	wave_timer_(counter_set, 0);
+	wave_timer_(start);
+}
+
+int
+wave_loop(const uint32_t *table, size_t len, uint32_t loops,
+		void (*done)(void))
+{
+	if (wave.busy || len == 0 || len > WAVE_MAX)
+		return -1;
+
+	wave.done = done;
+	wave.refill = NULL;
+	wave.buf[0] = wave.buf[1] = table;
+	wave.len = len;
+	wave.left = loops;
+
+	if (loops == 1) {
+		wave.unarmed = 0;
+		wave_arm(dma_primary(wave.ch), table, 1);
+	} else {
+		wave.unarmed = loops ? loops - 2 : 0;
+		wave_arm(dma_primary(wave.ch), table, 0);
+		wave_arm(dma_alternate(wave.ch), table, loops == 2);
+	}
+
+	wave_start();
+	return 0;
+}
+
+int
+wave_stream(uint32_t *buf0, uint32_t *buf1, size_t len,
+		void (*refill)(uint32_t *buf, size_t len))
+{
+	if (wave.busy || len == 0 || len > WAVE_MAX || refill == NULL)
+		return -1;
+
+	wave.done = NULL;
+	wave.refill = refill;
+	wave.buf[0] = buf0;
+	wave.buf[1] = buf1;
+	wave.len = len;
+	wave.left = 0;
+	wave.unarmed = 0;
+
+	wave_arm(dma_primary(wave.ch), buf0, 0);
+	wave_arm(dma_alternate(wave.ch), buf1, 0);
+
+	wave_start();
+	return 0;
+}
+
+void
+wave_stop(void)
+{
+	wave_end();
+}
+
+uint32_t
+wave_busy(void)
+{
+	return wave.busy;
+}
@@ -0,0 +1,178 @@
+/*
+ * This file is part of geckonator.
+ *
+ * geckonator is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * geckonator is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with geckonator. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+
+#include "geckonator/dma.h"
+#include "geckonator/ws2812.h"
+
+#define WS2812_BIT(n, b) ((((n) >> (b)) & 1U) ? 0x6U : 0x4U)
+#define WS2812_NIBBLE(n) \
+	( WS2812_BIT(n, 3) << 9 \
+	| WS2812_BIT(n, 2) << 6 \
+	| WS2812_BIT(n, 1) << 3 \
+	| WS2812_BIT(n, 0))
+
+#define WS2812_DMA_DATA \
+	( DMA_CTRL_DST_INC_NONE \
+	| DMA_CTRL_DST_SIZE_HALFWORD \
+	| DMA_CTRL_SRC_INC_HALFWORD \
+	| DMA_CTRL_SRC_SIZE_HALFWORD \
+	| DMA_CTRL_R_POWER_1)
+#define WS2812_DMA_RESET \
+	( DMA_CTRL_DST_INC_NONE \
+	| DMA_CTRL_DST_SIZE_HALFWORD \
+	| DMA_CTRL_SRC_INC_NONE \
+	| DMA_CTRL_SRC_SIZE_HALFWORD \
+	| DMA_CTRL_R_POWER_1)
+
+/* not const so it is copied to RAM along with ws2812_encode() */
+static uint16_t ws2812_table[16] = {
+	WS2812_NIBBLE(0x0), WS2812_NIBBLE(0x1), WS2812_NIBBLE(0x2), WS2812_NIBBLE(0x3),
+	WS2812_NIBBLE(0x4), WS2812_NIBBLE(0x5), WS2812_NIBBLE(0x6), WS2812_NIBBLE(0x7),
+	WS2812_NIBBLE(0x8), WS2812_NIBBLE(0x9), WS2812_NIBBLE(0xA), WS2812_NIBBLE(0xB),
+	WS2812_NIBBLE(0xC), WS2812_NIBBLE(0xD), WS2812_NIBBLE(0xE), WS2812_NIBBLE(0xF),
+};
+
+static uint16_t ws2812_zero;
+
+static struct {
+	const uint8_t *src;
+	size_t left;
+	void (*done)(void);
+	unsigned int ch;
+	bool reset;
+	uint16_t buf[2][2*WS2812_CHUNK];
+} ws2812;
+
+void __ramfunc
+ws2812_encode(uint16_t *dst, const uint8_t *src, size_t len)
+{
+	const uint16_t *table = ws2812_table;
+	const uint8_t *end = src + len;
+
+	while (src < end) {
+		unsigned int v = *src++;
+
+		dst[0] = table[v >> 4];
+		dst[1] = table[v & 0xFU];
+		dst += 2;
+	}
+}
+
+/* returns 1 if the descriptor was armed */
+static unsigned int
+ws2812_fill(struct dma_descriptor *d, uint16_t *buf)
+{
+	size_t n = ws2812.left;
+
+	if (n > 0) {
+		if (n > WS2812_CHUNK)
+			n = WS2812_CHUNK;
+
+		ws2812_encode(buf, ws2812.src, n);
+		ws2812.src += n;
+		ws2812.left -= n;
+
+		d->src_end = &buf[2*n - 1];
+		d->control = WS2812_DMA_DATA
+			| (2*n - 1) << _DMA_CTRL_N_MINUS_1_SHIFT
+			| DMA_CTRL_CYCLE_CTRL_PINGPONG;
+		return 1;
+	}
+
+	if (!ws2812.reset) {
+		ws2812.reset = true;
+
+		/* basic cycle so the channel stops when it's done */
+		d->src_end = &ws2812_zero;
+		d->control = WS2812_DMA_RESET
+			| (WS2812_RESET_FRAMES - 1) << _DMA_CTRL_N_MINUS_1_SHIFT
+			| DMA_CTRL_CYCLE_CTRL_BASIC;
+		return 1;
+	}
+
+	d->control = DMA_CTRL_CYCLE_CTRL_INVALID;
+	return 0;
+}
+
+static void
+ws2812_dma_handler(unsigned int ch)
+{
+	if (!dma_channel_enabled(ch)) {
+		if (ws2812.done)
+			ws2812.done();
+		return;
+	}
+
+	/* refill the descriptor which just finished */
+	if (dma_channel_alternate(ch))
+		ws2812_fill(dma_primary(ch), ws2812.buf[0]);
+	else
+		ws2812_fill(dma_alternate(ch), ws2812.buf[1]);
+}
+
+void
+ws2812_init(USART_TypeDef *usart, uint32_t pins,
+		unsigned int ch, uint32_t hfperclk)
+{
+	uint32_t div = (hfperclk + WS2812_BITRATE) / (2*WS2812_BITRATE);
+
+	usart->CMD = USART_CMD_RXDIS | USART_CMD_TXDIS | USART_CMD_MASTERDIS
+	           | USART_CMD_CLEARRX | USART_CMD_CLEARTX;
+	usart->CTRL = USART_CTRL_SYNC | USART_CTRL_MSBF;
+	usart->FRAME = USART_FRAME_DATABITS_TWELVE;
+	usart->CLKDIV = ((div - 1) << 8) & _USART_CLKDIV_DIV_MASK;
+	usart->ROUTE = pins;
+	usart->CMD = USART_CMD_MASTEREN | USART_CMD_TXEN;
+
+	/* frames of more than 9 bits are written to TXDOUBLE */
+	ws2812.ch = ch;
+	dma_primary(ch)->dst_end = &usart->TXDOUBLE;
+	dma_alternate(ch)->dst_end = &usart->TXDOUBLE;
+	dma_channel_config(ch, usart == USART0 ? DMAREQ_USART0_TXBL : DMAREQ_USART1_TXBL);
+	dma_channel_handler_set(ch, ws2812_dma_handler);
+	dma_flag_done_clear(ch);
+	dma_flag_done_enable(ch);
+	NVIC_EnableIRQ(DMA_IRQn);
+}
+
+int
+ws2812_write(const uint8_t *data, size_t len, void (*done)(void))
+{
+	unsigned int ch = ws2812.ch;
+
+	if (dma_channel_enabled(ch))
+		return -1;
+
+	ws2812.src = data;
+	ws2812.left = len;
+	ws2812.done = done;
+	ws2812.reset = false;
+
+	ws2812_fill(dma_primary(ch), ws2812.buf[0]);
+	ws2812_fill(dma_alternate(ch), ws2812.buf[1]);
+	dma_channel_alternate_disable(ch);
+	dma_channel_enable(ch);
+	return 0;
+}
+
+uint32_t
+ws2812_busy(void)
+{
+	return dma_channel_enabled(ws2812.ch);
+}
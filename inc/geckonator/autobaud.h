@@ -0,0 +1,52 @@
+#ifndef _GECKONATOR_AUTOBAUD_H
+#define _GECKONATOR_AUTOBAUD_H
+
+#include "common.h"
+#include "gpio.h"
+
+/*
+ * autobaud detection, drivers/autobaud.c
+ * needs drivers/dma.c and a descriptor table set with dma_base_set()
+ *
+ * uses CC0 of TIMER0 unless built with -DAUTOBAUD_TIMER=1 or 2.
+ * the clocks of the TIMER, PRS, GPIO and DMA must be enabled.
+ *
+ * the RX pin is routed through PRS to a TIMER running at HFPERCLK/1
+ * which captures both edges into memory by DMA. once the edges of
+ * the sync byte are captured the shortest pulse gives the number of
+ * bits spanned, and the bit time is the whole span divided by that.
+ * done is then called from the DMA interrupt with 16 times the bit
+ * time in HFPERCLK cycles, so it's all over within one character.
+ *
+ * start it while the line is idle. the default sync byte is 0x55,
+ * which has an edge on every bit and 10 edges in all. pulses must
+ * be shorter than 65536 HFPERCLK cycles.
+ */
+#ifndef AUTOBAUD_TIMER
+#define AUTOBAUD_TIMER 0
+#endif
+
+#define AUTOBAUD_EDGES_MAX 16
+#define AUTOBAUD_EDGES_0x55 10
+
+extern void autobaud_init(gpio_pin_t rx, unsigned int prs_ch, unsigned int dma_ch);
+extern int autobaud_start(unsigned int edges, void (*done)(uint32_t ticks16));
+extern void autobaud_cancel(void);
+extern uint32_t autobaud_busy(void);
+
+/* USART and TIMER both clocked by HFPERCLK */
+static inline uint32_t
+autobaud_usart_clock_div(uint32_t ticks16)
+{
+	return (ticks16 - 256) & _USART_CLKDIV_DIV_MASK;
+}
+
+/* LEUART clocked by LFBCLK */
+static inline uint32_t
+autobaud_leuart_clock_div(uint32_t ticks16, uint32_t hfperclk, uint32_t lfbclk)
+{
+	return ((uint32_t)((uint64_t)16*lfbclk*ticks16 / hfperclk) - 256)
+		& _LEUART_CLKDIV_DIV_MASK;
+}
+
+#endif
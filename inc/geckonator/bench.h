@@ -0,0 +1,90 @@
+#ifndef _GECKONATOR_BENCH_H
+#define _GECKONATOR_BENCH_H
+
+#include <stddef.h>
+
+#include "common.h"
+
+/*
+ * cycle counting benchmarks, drivers/bench.c
+ *
+ * the Cortex-M0+ has no cycle counter, so TIMER0 counts HFPERCLK
+ * instead, which is the core clock as long as the HFPERCLK and
+ * HFCORECLK dividers are both 1 like after reset. -DBENCH_TIMER=1
+ * picks TIMER1. 16 bits is enough for most things, built with
+ * -DBENCH_CASCADE the next TIMER up counts its overflows for a 32 bit
+ * count. the clock of the TIMERs must be enabled.
+ *
+ * BENCH_BEGIN(b) and BENCH_END(b) around a piece of code add a run to
+ * the struct bench b, less the cost of the macros themselves as
+ * measured by bench_init(). the first run also adds b to the list
+ * printed by bench_dump(), which hands each line to write, eg.
+ * console_write(), until it's all taken.
+ */
+#ifndef BENCH_TIMER
+#define BENCH_TIMER 0
+#endif
+
+#if BENCH_TIMER == 1
+#include "timer1.h"
+#ifdef BENCH_CASCADE
+#include "timer2.h"
+#define bench_hi_(name, ...) timer2_##name(__VA_ARGS__)
+#endif
+#define bench_lo_(name, ...) timer1_##name(__VA_ARGS__)
+#else
+#include "timer0.h"
+#ifdef BENCH_CASCADE
+#include "timer1.h"
+#define bench_hi_(name, ...) timer1_##name(__VA_ARGS__)
+#endif
+#define bench_lo_(name, ...) timer0_##name(__VA_ARGS__)
+#endif
+
+#ifdef BENCH_CASCADE
+#define BENCH_MASK 0xFFFFFFFFU
+#else
+#define BENCH_MASK 0xFFFFU
+#endif
+
+struct bench {
+	struct bench *next;
+	const char *name;
+	uint32_t runs;
+	uint32_t min;
+	uint32_t max;
+	uint32_t total;
+};
+
+#define BENCH_DEFINE(b, str) struct bench b = { .name = str }
+
+static inline uint32_t
+bench_counter(void)
+{
+#ifdef BENCH_CASCADE
+	uint32_t hi;
+	uint32_t lo;
+
+	do {
+		hi = bench_hi_(counter);
+		lo = bench_lo_(counter);
+	} while (hi != bench_hi_(counter));
+
+	return hi << 16 | lo;
+#else
+	return bench_lo_(counter);
+#endif
+}
+
+#define BENCH_BEGIN(b) do { \
+	uint32_t bench_start_ = bench_counter()
+#define BENCH_END(b) \
+	bench_add(&(b), bench_counter() - bench_start_); \
+} while (0)
+
+extern void bench_init(void);
+extern uint32_t bench_overhead(void);
+extern void bench_add(struct bench *b, uint32_t cycles);
+extern void bench_dump(size_t (*write)(const void *buf, size_t len));
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef _GECKONATOR_CALENDAR_H
+#define _GECKONATOR_CALENDAR_H
+
+#include <stddef.h>
+
+#include "common.h"
+
+/*
+ * wall clock on the RTC, drivers/calendar.c
+ * needs drivers/swtimer.c, set up with swtimer_init() first
+ *
+ * the RTC ticks are extended to 64 bits, and turned into seconds
+ * since 1970-01-01 00:00:00 with a fixed point tick length of 2^-40
+ * seconds, so the clock is exactly as good as the crystal behind it.
+ * the rate is given in mHz and may be changed on the fly, eg. by a
+ * calibration against a better clock, without the time jumping.
+ *
+ * every 2^30 ticks a software timer folds the ticks since the last
+ * time into the base, so a reading is a single 32x32 multiply away
+ * from the RTC counter. readers never disable interrupts, they only
+ * read again if the base was moved underneath them, and so may be
+ * called from any interrupt handler.
+ *
+ * the state is in RAM and the RTC keeps counting in EM2, and in EM3
+ * too when it runs from the ULFRCO, so the clock carries on through
+ * both. at 32768Hz the timer wakes the CPU once every 9 hours.
+ *
+ * calendar_split() and calendar_join() convert between seconds and
+ * dates in the proleptic Gregorian calendar without dividing, for
+ * years 1970 to 9999.
+ */
+struct calendar_date {
+	uint16_t year;
+	uint8_t month;    /* 1 to 12 */
+	uint8_t day;      /* 1 to 31 */
+	uint8_t hour;
+	uint8_t minute;
+	uint8_t second;
+	uint8_t weekday;  /* 0 is Sunday */
+};
+
+extern int calendar_init(uint32_t mhz);
+extern int calendar_rate_set(uint32_t mhz);
+extern uint64_t calendar_ticks(void);
+extern uint64_t calendar_seconds(uint16_t *subsec);
+extern void calendar_set(uint64_t seconds, uint16_t subsec);
+extern void calendar_split(uint64_t seconds, struct calendar_date *date);
+extern uint64_t calendar_join(const struct calendar_date *date);
+
+static inline void
+calendar_now(struct calendar_date *date)
+{
+	calendar_split(calendar_seconds(NULL), date);
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef _GECKONATOR_CALIBRATE_H
+#define _GECKONATOR_CALIBRATE_H
+
+#include "common.h"
+#include "swtimer.h"
+
+/*
+ * oscillator calibration, drivers/calibrate.c
+ * needs drivers/swtimer.c, set up with swtimer_init() first
+ *
+ * measures one oscillator against another with the CMU calibration
+ * counters: the reference counts down top cycles while the up
+ * counter counts the oscillator. top is picked so the up counter
+ * doesn't overflow, and for a 20MHz HFRCO against the LFXO still
+ * resolves about 1ppm. the USHFRCO makes a good reference while its
+ * clock recovery is locked to the USB SOF.
+ *
+ * fill in osc, ref, ref_hz and hz, the nominal rate of osc, of a job
+ * that starts out zeroed and start it with calibrate_start(). the measurement runs on its own and
+ * a software timer comes back for the result, so nothing waits for
+ * it. jobs share the counters and are run one after the other. done
+ * is called from the RTC interrupt with hz set to the measured rate,
+ * and may pass it on, eg. to calendar_rate_set() or the baud rate
+ * set up of a UART running from the HFRCO. with period set the job
+ * runs again that many RTC ticks later, until calibrate_stop().
+ *
+ * with target_hz set for the HFRCO or AUXHFRCO their tuning is moved
+ * towards it after each measurement, by a step learned from the
+ * effect of the steps before. the ULFRCO isn't connected to the
+ * counters and can't be measured.
+ */
+enum calibrate_osc {
+	CALIBRATE_HFXO     = _CMU_CALCTRL_UPSEL_HFXO,
+	CALIBRATE_LFXO     = _CMU_CALCTRL_UPSEL_LFXO,
+	CALIBRATE_HFRCO    = _CMU_CALCTRL_UPSEL_HFRCO,
+	CALIBRATE_LFRCO    = _CMU_CALCTRL_UPSEL_LFRCO,
+	CALIBRATE_AUXHFRCO = _CMU_CALCTRL_UPSEL_AUXHFRCO,
+	CALIBRATE_USHFRCO  = _CMU_CALCTRL_UPSEL_USHFRCO,
+};
+
+struct calibrate {
+	struct swtimer timer;
+	struct calibrate *next;
+	void (*done)(struct calibrate *c);
+	uint32_t ref_hz;     /* rate of ref */
+	uint32_t hz;         /* nominal rate of osc, then the one measured */
+	uint32_t target_hz;  /* HFRCO and AUXHFRCO are tuned to this, if set */
+	uint32_t period;     /* RTC ticks between runs, 0 to run once */
+	uint32_t top;
+	uint32_t count;
+	uint32_t last_hz;
+	int32_t step;        /* Hz per tuning step */
+	uint8_t last_tuning;
+	uint8_t osc;
+	uint8_t ref;
+	uint8_t queued;
+};
+
+extern void calibrate_init(uint32_t rtc_hz);
+extern int calibrate_start(struct calibrate *c);
+extern void calibrate_stop(struct calibrate *c);
+
+/* the measured rate in mHz, for oscillators below 4MHz */
+static inline uint32_t
+calibrate_mhz(const struct calibrate *c)
+{
+	return (uint64_t)c->count * c->ref_hz * 1000 / c->top;
+}
+
+#endif
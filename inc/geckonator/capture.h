@@ -0,0 +1,56 @@
+#ifndef _GECKONATOR_CAPTURE_H
+#define _GECKONATOR_CAPTURE_H
+
+#include "common.h"
+#include "gpio.h"
+
+/*
+ * period, frequency and duty cycle measurement, drivers/capture.c
+ * needs drivers/dma.c and a descriptor table set with dma_base_set()
+ *
+ * uses CC0, CC1 and the interrupt of TIMER0 unless built with
+ * -DCAPTURE_TIMER=1 or 2. the clocks of the TIMER, PRS, GPIO and DMA
+ * must be enabled.
+ *
+ * the input is routed through PRS to CC0, capturing rising edges,
+ * and CC1, capturing falling edges. DMA moves both into ping-pong
+ * buffers of CAPTURE_BATCH captures each, so there's no interrupt per
+ * edge. when both halves are full, done is called from the DMA
+ * interrupt with the figures for those CAPTURE_BATCH periods.
+ *
+ * the 16 bit timer is extended with its overflow interrupt, so the
+ * periods themselves may be any length, but high times must stay
+ * below 65536 ticks. a batch must be handled before the other half
+ * fills up, which at 200kHz and the default 32 is 160us. if the DMA
+ * falls behind the TIMER's capture buffers overflow, done gets a
+ * batch with CAPTURE_OVERFLOW and measurement starts over.
+ */
+#ifndef CAPTURE_TIMER
+#define CAPTURE_TIMER 0
+#endif
+
+#ifndef CAPTURE_BATCH
+#define CAPTURE_BATCH 32
+#endif
+
+enum capture_status {
+	CAPTURE_OK = 0,
+	CAPTURE_OVERFLOW,
+};
+
+struct capture_batch {
+	uint32_t ticks;   /* timer ticks spanned by the CAPTURE_BATCH periods */
+	uint32_t high;    /* ticks the input was high in them */
+	uint32_t period;  /* average period in 1/256 ticks */
+	uint32_t freq;    /* frequency in mHz */
+	uint16_t duty;    /* high time in 1/65536 of the period */
+	uint8_t status;
+};
+
+extern void capture_init(gpio_pin_t in, unsigned int prs_ch,
+		unsigned int rise_ch, unsigned int fall_ch,
+		uint32_t hfperclk, unsigned int shift);
+extern void capture_start(void (*done)(const struct capture_batch *b));
+extern void capture_stop(void);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef _GECKONATOR_CASCADE_H
+#define _GECKONATOR_CASCADE_H
+
+#include "common.h"
+
+/*
+ * 32 bit timer from two cascaded TIMERs, drivers/cascade.c
+ *
+ * TIMER0 counts HFPERCLK/(1 << shift) and TIMER1 counts its overflows,
+ * which reach it over a PRS channel and the CC1 input. any other pair
+ * may be picked with -DCASCADE_LOW=n and -DCASCADE_HIGH=m. the clocks
+ * of both TIMERs and PRS must be enabled.
+ *
+ * the high half lags the low one by a few cycles when it wraps, so
+ * reading both at once doesn't give a coherent count. instead
+ * cascade_counter() reads the high half both before and after the low
+ * half and uses the one that can't be off: the first when the low
+ * half is past the middle and the last wrap long ago, and the second
+ * when it's before the middle and the next wrap is far off.
+ *
+ * cascade_compare() first waits for the high half with CC0 of the
+ * high TIMER, then for the low half with CC0 of the low TIMER, so the
+ * only interrupts are those two. captures use CC2 of the low TIMER,
+ * fed from a PRS channel, and are extended to 32 bits in its
+ * interrupt, which must not be held off for 65536 ticks.
+ */
+#ifndef CASCADE_LOW
+#define CASCADE_LOW 0
+#endif
+#ifndef CASCADE_HIGH
+#define CASCADE_HIGH 1
+#endif
+
+extern void cascade_init(unsigned int prs_ch, unsigned int shift);
+extern uint32_t cascade_counter(void);
+extern int cascade_compare(uint32_t t, void (*fn)(void));
+extern void cascade_compare_cancel(void);
+extern void cascade_capture_start(unsigned int prs_ch, uint32_t edge,
+		void (*fn)(uint32_t t));
+extern void cascade_capture_stop(void);
+
+#endif
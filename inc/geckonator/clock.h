@@ -21,6 +21,8 @@ clock_hfclk_select_hfrco(void)    { CMU->CMD = CMU_CMD_HFCLKSEL_HFRCO; }
 static inline void
 clock_hfclk_select_hfxo(void)     { CMU->CMD = CMU_CMD_HFCLKSEL_HFXO; }
 static inline void
+clock_hfclk_select_lfxo(void)     { CMU->CMD = CMU_CMD_HFCLKSEL_LFXO; }
+static inline void
 clock_hfclk_select_lfrco(void)    { CMU->CMD = CMU_CMD_HFCLKSEL_LFRCO; }
 static inline void
 clock_hfclk_select_ushfrco(void)  { CMU->CMD = CMU_CMD_HFCLKSEL_USHFRCODIV2; }
@@ -55,6 +57,48 @@ clock_peripheral_div256(void)     { CMU->HFPERCLKDIV = CMU_HFPERCLKDIV_HFPERCLKE
 static inline void
 clock_peripheral_div512(void)     { CMU->HFPERCLKDIV = CMU_HFPERCLKDIV_HFPERCLKEN | CMU_HFPERCLKDIV_HFPERCLKDIV_HFCLK512; }
 
+/* CMU_HFRCOCTRL */
+enum clock_hfrco_band {
+	CLOCK_HFRCO_1MHZ  = CMU_HFRCOCTRL_BAND_1MHZ,
+	CLOCK_HFRCO_7MHZ  = CMU_HFRCOCTRL_BAND_7MHZ,
+	CLOCK_HFRCO_11MHZ = CMU_HFRCOCTRL_BAND_11MHZ,
+	CLOCK_HFRCO_14MHZ = CMU_HFRCOCTRL_BAND_14MHZ,
+	CLOCK_HFRCO_21MHZ = CMU_HFRCOCTRL_BAND_21MHZ,
+};
+static inline uint32_t
+clock_hfrco_band(void)            { return CMU->HFRCOCTRL & _CMU_HFRCOCTRL_BAND_MASK; }
+static inline void
+clock_hfrco_band_set(uint32_t v)
+{
+	CMU->HFRCOCTRL = (CMU->HFRCOCTRL & ~_CMU_HFRCOCTRL_BAND_MASK) | v;
+}
+static inline uint32_t
+clock_hfrco_tuning(void)          { return CMU->HFRCOCTRL & _CMU_HFRCOCTRL_TUNING_MASK; }
+static inline void
+clock_hfrco_tuning_set(uint32_t v)
+{
+	CMU->HFRCOCTRL = (CMU->HFRCOCTRL & ~_CMU_HFRCOCTRL_TUNING_MASK) | v;
+}
+
+/* CMU_AUXHFRCOCTRL */
+static inline uint32_t
+clock_auxhfrco_tuning(void)       { return CMU->AUXHFRCOCTRL & _CMU_AUXHFRCOCTRL_TUNING_MASK; }
+static inline void
+clock_auxhfrco_tuning_set(uint32_t v)
+{
+	CMU->AUXHFRCOCTRL = (CMU->AUXHFRCOCTRL & ~_CMU_AUXHFRCOCTRL_TUNING_MASK) | v;
+}
+
+/* CMU_CALCTRL */
+static inline void
+clock_calibration_config(uint32_t v) { CMU->CALCTRL = v; }
+
+/* CMU_CALCNT */
+static inline uint32_t
+clock_calibration_count(void)     { return CMU->CALCNT; }
+static inline void
+clock_calibration_count_set(uint32_t v) { CMU->CALCNT = v; }
+
 /* CMU_OSCENCMD */
 static inline void
 clock_ushfrco_disable(void)       { CMU->OSCENCMD = CMU_OSCENCMD_USHFRCODIS; }
@@ -163,7 +207,7 @@ static inline void clock_lfc_select_lfrco(void)
 }
 static inline void clock_lfc_select_lfxo(void)
 {
-	CMU->LFCLKSEL = (CMU->LFCLKSEL & ~(_CMU_LFCLKSEL_LFB_MASK)) | CMU_LFCLKSEL_LFC_LFXO;
+	CMU->LFCLKSEL = (CMU->LFCLKSEL & ~(_CMU_LFCLKSEL_LFC_MASK)) | CMU_LFCLKSEL_LFC_LFXO;
 }
 
 /* CMU_STATUS */
@@ -216,6 +260,34 @@ clock_hfrco_ready(void)            { return CMU->STATUS & CMU_STATUS_HFRCORDY; }
 static inline uint32_t
 clock_hfrco_enabled(void)          { return CMU->STATUS & CMU_STATUS_HFRCOENS; }
 
+/* CMU_IF */
+static inline uint32_t
+clock_flags(void)                 { return CMU->IF; }
+static inline uint32_t
+clock_flag_lfxo_ready(uint32_t v) { return v & CMU_IF_LFXORDY; }
+static inline uint32_t
+clock_flag_hfxo_ready(uint32_t v) { return v & CMU_IF_HFXORDY; }
+
+/* CMU_IFS */
+static inline void
+clock_flags_set(uint32_t v)       { CMU->IFS = v; }
+
+/* CMU_IFC */
+static inline void
+clock_flags_clear(uint32_t v)     { CMU->IFC = v; }
+
+/* CMU_IEN */
+static inline uint32_t
+clock_flags_enabled(void)         { return CMU->IEN; }
+static inline void
+clock_flag_lfxo_ready_disable(void) { CMU->IEN &= ~CMU_IEN_LFXORDY; }
+static inline void
+clock_flag_lfxo_ready_enable(void)  { CMU->IEN |= CMU_IEN_LFXORDY; }
+static inline void
+clock_flag_hfxo_ready_disable(void) { CMU->IEN &= ~CMU_IEN_HFXORDY; }
+static inline void
+clock_flag_hfxo_ready_enable(void)  { CMU->IEN |= CMU_IEN_HFXORDY; }
+
 /* CMU_HFCORECLKEN0 */
 static inline void
 clock_usb_disable(void)            { CMU->HFCORECLKEN0 &= ~CMU_HFCORECLKEN0_USB; }
@@ -395,6 +467,14 @@ clock_ushfrco_recovery_disable(void)
 	CMU->USBCRCTRL = 0;
 }
 
+/* CMU_USHFRCOCTRL */
+static inline uint32_t
+clock_ushfrco_tuning(void)        { return CMU->USHFRCOCTRL & _CMU_USHFRCOCTRL_TUNING_MASK; }
+
+/* CMU_USHFRCOTUNE */
+static inline uint32_t
+clock_ushfrco_finetuning(void)    { return CMU->USHFRCOTUNE & _CMU_USHFRCOTUNE_FINETUNING_MASK; }
+
 /* CMU_USHFRCOCONF */
 static inline void clock_ushfrco_48mhz_div2(void)
 {
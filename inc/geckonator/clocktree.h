@@ -0,0 +1,97 @@
+#ifndef _GECKONATOR_CLOCKTREE_H
+#define _GECKONATOR_CLOCKTREE_H
+
+#include "common.h"
+
+/*
+ * clock frequencies and shared clock gates, drivers/clocktree.c
+ *
+ * the frequencies are worked out from the CMU registers each time
+ * they're asked for, so they follow every change made with clock.h
+ * and never go stale. what the CMU can't know is the rate of the
+ * crystals, CLOCKTREE_HFXO_HZ and CLOCKTREE_LFXO_HZ unless set with
+ * clocktree_osc_set(), which also takes measured rates of the RC
+ * oscillators, eg. from drivers/calibrate.c. the HFRCO rate set
+ * applies to the band it was set in only, in other bands the nominal
+ * rate is used.
+ *
+ * drivers sharing a clock gate take it with clocktree_get() and
+ * give it back with clocktree_put(), and the clock is only turned off
+ * when the last user is done. the LF peripherals hold the LE clock
+ * and USBC holds USB. a gate that was already on when first taken
+ * was turned on with clock.h directly, eg. in main.c for drivers
+ * that don't hold it, so it's left on.
+ *
+ * oscillators are shared the same way with clocktree_osc_get() and
+ * clocktree_osc_put(), which don't wait for them to be ready. one is
+ * only turned off again if clocktree turned it on and the CMU no
+ * longer routes it to HFCLK, an LF clock or USBC, so it's safe next
+ * to drivers using clock.h directly. clocktree_osc_adopt() lets it
+ * turn off one that was already running, eg. the HFRCO after reset.
+ */
+#ifndef CLOCKTREE_HFXO_HZ
+#define CLOCKTREE_HFXO_HZ 24000000
+#endif
+
+#ifndef CLOCKTREE_LFXO_HZ
+#define CLOCKTREE_LFXO_HZ 32768
+#endif
+
+/* in the order of the calibration counter inputs */
+enum clocktree_osc {
+	CLOCKTREE_HFXO,
+	CLOCKTREE_LFXO,
+	CLOCKTREE_HFRCO,
+	CLOCKTREE_LFRCO,
+	CLOCKTREE_AUXHFRCO,
+	CLOCKTREE_USHFRCO,
+	CLOCKTREE_ULFRCO,
+	CLOCKTREE_OSCS,
+};
+
+enum clocktree_gate {
+	/* HFPERCLK, in the order of CMU_HFPERCLKEN0 */
+	CLOCKTREE_TIMER0,
+	CLOCKTREE_TIMER1,
+	CLOCKTREE_TIMER2,
+	CLOCKTREE_USART0,
+	CLOCKTREE_USART1,
+	CLOCKTREE_ACMP0,
+	CLOCKTREE_PRS,
+	CLOCKTREE_IDAC0,
+	CLOCKTREE_GPIO,
+	CLOCKTREE_VCMP,
+	CLOCKTREE_ADC0,
+	CLOCKTREE_I2C0,
+	/* HFCORECLK, in the order of CMU_HFCORECLKEN0 */
+	CLOCKTREE_AES,
+	CLOCKTREE_DMA,
+	CLOCKTREE_LE,
+	CLOCKTREE_USBC,
+	CLOCKTREE_USB,
+	/* LFACLK, LFBCLK and LFCCLK */
+	CLOCKTREE_RTC,
+	CLOCKTREE_LEUART0,
+	CLOCKTREE_USBLE,
+	CLOCKTREE_GATES,
+};
+
+extern void clocktree_osc_set(enum clocktree_osc osc, uint32_t hz);
+extern uint32_t clocktree_osc(enum clocktree_osc osc);
+extern uint32_t clocktree_hfclk(void);
+extern uint32_t clocktree_hfcoreclk(void);
+extern uint32_t clocktree_hfperclk(void);
+extern uint32_t clocktree_lfa(void);
+extern uint32_t clocktree_lfb(void);
+extern uint32_t clocktree_lfc(void);
+extern uint32_t clocktree_rtc(void);
+extern uint32_t clocktree_leuart0(void);
+
+extern void clocktree_get(enum clocktree_gate g);
+extern void clocktree_put(enum clocktree_gate g);
+
+extern void clocktree_osc_get(enum clocktree_osc osc);
+extern void clocktree_osc_put(enum clocktree_osc osc);
+extern void clocktree_osc_adopt(enum clocktree_osc osc);
+
+#endif
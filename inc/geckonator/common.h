@@ -27,8 +27,24 @@
 #define __uninitialized __attribute__((section(".uninit")))
 #endif
 
+#ifndef __ramfunc
+#define __ramfunc __attribute__((section(".ram"), long_call, noinline))
+#endif
+
 #ifndef __align
 #define __align(x) __attribute__((aligned(x)))
 #endif
 
+/* nestable critical section */
+static inline uint32_t
+irq_save(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+static inline void
+irq_restore(uint32_t primask)     { __set_PRIMASK(primask); }
+
 #endif
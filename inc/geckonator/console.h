@@ -0,0 +1,45 @@
+#ifndef _GECKONATOR_CONSOLE_H
+#define _GECKONATOR_CONSOLE_H
+
+#include <stddef.h>
+
+#include "common.h"
+
+/*
+ * LEUART0 console, drivers/console.c
+ * needs drivers/dma.c and a descriptor table set with dma_base_set()
+ *
+ * the LEUART runs from LFBCLK, so the MCU can sleep in EM2 with
+ * emu_deep_sleep_enable() while waiting for input. with a start frame
+ * the receiver stays blocked until that character arrives, and is
+ * blocked again after the signal frame, eg. '\r', so nothing but the
+ * start frame wakes the MCU. every character in between is passed to
+ * the rx callback from the LEUART interrupt.
+ *
+ * output is copied into a ring buffer of CONSOLE_TX_SIZE bytes and
+ * sent by DMA which the LEUART wakes up in EM2. console_write()
+ * never waits, it returns how much was queued.
+ *
+ * the LEUART is configured in one freeze/update batch and commands
+ * from the interrupt handlers are deferred while the LF domain is
+ * still busy with a previous write. they are committed by the next
+ * interrupt or by console_sync(), which should be called before going
+ * to sleep. console_sync() is a last resort flush: it busy-waits up
+ * to a few LFBCLK cycles for the LF domain, though with interrupts
+ * enabled.
+ */
+#ifndef CONSOLE_TX_SIZE
+#define CONSOLE_TX_SIZE 256
+#endif
+
+#define CONSOLE_NONE (-1)
+
+extern void console_init(uint32_t pins, uint32_t clkdiv,
+		int start, int signal, unsigned int dma_ch,
+		void (*rx)(uint8_t c));
+extern size_t console_write(const void *buf, size_t len);
+extern size_t console_puts(const char *str);
+extern void console_sync(void);
+extern uint32_t console_busy(void);
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef _GECKONATOR_DEVINFO_H
+#define _GECKONATOR_DEVINFO_H
+
+#include "common.h"
+
+/*
+ * device information page, written at the factory
+ *
+ * the HFRCO, AUXHFRCO and USHFRCO are trimmed per band, and the
+ * tuning found at reset only fits the band they start in. the
+ * _band_set() functions change band and tuning together with
+ * interrupts disabled, so nothing else retunes in between. for the
+ * HFRCO and AUXHFRCO that is a single register write, and they
+ * never run a band with the tuning of another.
+ */
+
+/* DEVINFO_CAL */
+static inline uint32_t
+devinfo_cal_temperature(void)  { return (DEVINFO->CAL & _DEVINFO_CAL_TEMP_MASK) >> _DEVINFO_CAL_TEMP_SHIFT; }
+
+/* DEVINFO_ADC0CALn */
+static inline uint32_t
+devinfo_adc0_cal(unsigned int i)
+{
+	return (&DEVINFO->ADC0CAL0)[i];
+}
+
+/* DEVINFO_IDAC0CAL0 */
+static inline uint32_t
+devinfo_idac0_tuning(unsigned int range)
+{
+	return (DEVINFO->IDAC0CAL0 >> (8 * range)) & 0xFFU;
+}
+
+/* DEVINFO_USHFRCOCAL0 */
+static inline uint32_t
+devinfo_ushfrco_cal(void)      { return DEVINFO->USHFRCOCAL0; }
+
+/* band is CMU_USHFRCOCONF_BAND_24MHZ or _48MHZ, the divider is kept */
+static inline void
+devinfo_ushfrco_band_set(uint32_t band)
+{
+	uint32_t cal = DEVINFO->USHFRCOCAL0;
+	uint32_t primask;
+
+	if (band == CMU_USHFRCOCONF_BAND_24MHZ)
+		cal >>= _DEVINFO_USHFRCOCAL0_BAND24_TUNING_SHIFT;
+	else
+		cal >>= _DEVINFO_USHFRCOCAL0_BAND48_TUNING_SHIFT;
+
+	primask = irq_save();
+	CMU->USHFRCOCONF = (CMU->USHFRCOCONF & ~_CMU_USHFRCOCONF_BAND_MASK) | band;
+	CMU->USHFRCOCTRL = (CMU->USHFRCOCTRL & ~_CMU_USHFRCOCTRL_TUNING_MASK)
+		| (cal & _CMU_USHFRCOCTRL_TUNING_MASK);
+	CMU->USHFRCOTUNE = (CMU->USHFRCOTUNE & ~_CMU_USHFRCOTUNE_FINETUNING_MASK)
+		| ((cal >> 8) & _CMU_USHFRCOTUNE_FINETUNING_MASK);
+	irq_restore(primask);
+}
+
+/* DEVINFO_HFRCOCALn, band is CLOCK_HFRCO_*MHZ */
+static inline uint32_t
+devinfo_hfrco_tuning(uint32_t band)
+{
+	unsigned int i = band >> _CMU_HFRCOCTRL_BAND_SHIFT;
+
+	if (i == _CMU_HFRCOCTRL_BAND_21MHZ)
+		return DEVINFO->HFRCOCAL1 & _DEVINFO_HFRCOCAL1_BAND21_MASK;
+	return (DEVINFO->HFRCOCAL0 >> (8 * i)) & 0xFFU;
+}
+
+static inline void
+devinfo_hfrco_band_set(uint32_t band)
+{
+	uint32_t tuning = devinfo_hfrco_tuning(band);
+	uint32_t primask = irq_save();
+
+	CMU->HFRCOCTRL = (CMU->HFRCOCTRL
+			& ~(_CMU_HFRCOCTRL_BAND_MASK | _CMU_HFRCOCTRL_TUNING_MASK))
+		| band | tuning;
+	irq_restore(primask);
+}
+
+/* DEVINFO_AUXHFRCOCALn, band is CMU_AUXHFRCOCTRL_BAND_*MHZ */
+static inline uint32_t
+devinfo_auxhfrco_tuning(uint32_t band)
+{
+	switch (band >> _CMU_AUXHFRCOCTRL_BAND_SHIFT) {
+	case _CMU_AUXHFRCOCTRL_BAND_1MHZ:
+		return (DEVINFO->AUXHFRCOCAL0 & _DEVINFO_AUXHFRCOCAL0_BAND1_MASK)
+			>> _DEVINFO_AUXHFRCOCAL0_BAND1_SHIFT;
+	case _CMU_AUXHFRCOCTRL_BAND_7MHZ:
+		return (DEVINFO->AUXHFRCOCAL0 & _DEVINFO_AUXHFRCOCAL0_BAND7_MASK)
+			>> _DEVINFO_AUXHFRCOCAL0_BAND7_SHIFT;
+	case _CMU_AUXHFRCOCTRL_BAND_11MHZ:
+		return (DEVINFO->AUXHFRCOCAL0 & _DEVINFO_AUXHFRCOCAL0_BAND11_MASK)
+			>> _DEVINFO_AUXHFRCOCAL0_BAND11_SHIFT;
+	case _CMU_AUXHFRCOCTRL_BAND_21MHZ:
+		return (DEVINFO->AUXHFRCOCAL1 & _DEVINFO_AUXHFRCOCAL1_BAND21_MASK)
+			>> _DEVINFO_AUXHFRCOCAL1_BAND21_SHIFT;
+	default:
+		return (DEVINFO->AUXHFRCOCAL0 & _DEVINFO_AUXHFRCOCAL0_BAND14_MASK)
+			>> _DEVINFO_AUXHFRCOCAL0_BAND14_SHIFT;
+	}
+}
+
+static inline void
+devinfo_auxhfrco_band_set(uint32_t band)
+{
+	uint32_t tuning = devinfo_auxhfrco_tuning(band);
+	uint32_t primask = irq_save();
+
+	CMU->AUXHFRCOCTRL = (CMU->AUXHFRCOCTRL
+			& ~(_CMU_AUXHFRCOCTRL_BAND_MASK | _CMU_AUXHFRCOCTRL_TUNING_MASK))
+		| band | tuning;
+	irq_restore(primask);
+}
+
+/* DEVINFO_MEMINFO */
+static inline uint32_t
+devinfo_flash_page_size(void)
+{
+	return 1U << (((DEVINFO->MEMINFO & _DEVINFO_MEMINFO_FLASH_PAGE_SIZE_MASK)
+				>> _DEVINFO_MEMINFO_FLASH_PAGE_SIZE_SHIFT) + 10);
+}
+
+/* DEVINFO_UNIQUEL, DEVINFO_UNIQUEH */
+static inline uint64_t
+devinfo_unique(void)
+{
+	return (uint64_t)DEVINFO->UNIQUEH << 32 | DEVINFO->UNIQUEL;
+}
+
+/* DEVINFO_MSIZE */
+static inline uint32_t
+devinfo_flash_kb(void)         { return (DEVINFO->MSIZE & _DEVINFO_MSIZE_FLASH_MASK) >> _DEVINFO_MSIZE_FLASH_SHIFT; }
+static inline uint32_t
+devinfo_sram_kb(void)          { return (DEVINFO->MSIZE & _DEVINFO_MSIZE_SRAM_MASK) >> _DEVINFO_MSIZE_SRAM_SHIFT; }
+
+/* DEVINFO_PART */
+static inline uint32_t
+devinfo_part_number(void)      { return (DEVINFO->PART & _DEVINFO_PART_DEVICE_NUMBER_MASK) >> _DEVINFO_PART_DEVICE_NUMBER_SHIFT; }
+static inline uint32_t
+devinfo_part_family(void)      { return (DEVINFO->PART & _DEVINFO_PART_DEVICE_FAMILY_MASK) >> _DEVINFO_PART_DEVICE_FAMILY_SHIFT; }
+static inline uint32_t
+devinfo_part_revision(void)    { return (DEVINFO->PART & _DEVINFO_PART_PROD_REV_MASK) >> _DEVINFO_PART_PROD_REV_SHIFT; }
+
+#endif
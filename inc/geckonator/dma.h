@@ -247,6 +247,8 @@ static inline void
 dma_flag_done_clear(unsigned int i)          { DMA->IFC = 1 << i; }
 
 /* DMA_IEN */
+static inline uint32_t
+dma_flags_enabled(uint32_t v)                { return v & DMA->IEN; }
 static inline void
 dma_flag_error_disable(void)                 { DMA->IEN &= ~DMA_IEN_ERR; }
 static inline void
@@ -263,4 +265,13 @@ dma_channel_config(unsigned int i, uint32_t v)
 	DMA->CH[i].CTRL = v;
 }
 
+/* descriptors of the table set with dma_base_set() */
+static inline struct dma_descriptor *
+dma_primary(unsigned int i)                  { return &dma_base()[i]; }
+static inline struct dma_descriptor *
+dma_alternate(unsigned int i)                { return &dma_altbase()[i]; }
+
+/* drivers/dma.c */
+extern void dma_channel_handler_set(unsigned int i, void (*fn)(unsigned int i));
+
 #endif
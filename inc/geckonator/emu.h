@@ -23,6 +23,12 @@ emu_unlock(void)                  { EMU->LOCK = 0xADE8U; }
 static inline uint32_t
 emu_locked(void)                  { return EMU->LOCK; }
 
+/* SCB_SCR, __WFI() enters EM2 or EM3 instead of EM1 */
+static inline void
+emu_deep_sleep_enable(void)       { SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk; }
+static inline void
+emu_deep_sleep_disable(void)      { SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk; }
+
 /* EMU_AUXCTRL */
 extern void emu_reset_cause_clear(void);
 
@@ -2,7 +2,16 @@
 #define _GECKONATOR_I2C_H
 
 enum i2c_config {
-	I2C_CONFIG_ENABLE = I2C_CTRL_EN,
+	I2C_CONFIG_ENABLE          = I2C_CTRL_EN,
+	I2C_CONFIG_CLTO_40PCC      = I2C_CTRL_CLTO_40PCC,
+	I2C_CONFIG_CLTO_80PCC      = I2C_CTRL_CLTO_80PCC,
+	I2C_CONFIG_CLTO_160PCC     = I2C_CTRL_CLTO_160PCC,
+	I2C_CONFIG_CLTO_320PCC     = I2C_CTRL_CLTO_320PPC,
+	I2C_CONFIG_CLTO_1024PCC    = I2C_CTRL_CLTO_1024PPC,
+	I2C_CONFIG_BITO_40PCC      = I2C_CTRL_BITO_40PCC,
+	I2C_CONFIG_BITO_80PCC      = I2C_CTRL_BITO_80PCC,
+	I2C_CONFIG_BITO_160PCC     = I2C_CTRL_BITO_160PCC,
+	I2C_CONFIG_GO_IDLE_ON_BITO = I2C_CTRL_GIBITO,
 };
 
 enum i2c_flags {
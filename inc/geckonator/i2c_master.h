@@ -0,0 +1,71 @@
+#ifndef _GECKONATOR_I2C_MASTER_H
+#define _GECKONATOR_I2C_MASTER_H
+
+#include <stddef.h>
+
+#include "common.h"
+#include "gpio.h"
+
+/*
+ * interrupt driven I2C master, drivers/i2c_master.c
+ *
+ * transfers are queued with i2c_master_submit() and run one after
+ * another from I2C0_IRQHandler, so the CPU can sleep in EM1 while
+ * they're on the bus. a transfer writes wlen bytes, reads rlen bytes
+ * or does both with a repeated start in between, and done is called
+ * from the interrupt when it has ended with STOP. reading a bunch of
+ * sensors is then just submitting a transfer for each in one go.
+ *
+ * the transfer structs belong to the caller and must be left alone
+ * until done has been called, after which they may be submitted
+ * again, even from done itself.
+ *
+ * config takes the I2C_CONFIG_CLTO_* and I2C_CONFIG_BITO_* timeouts,
+ * in SCL periods. a transfer cut short by a lost arbitration or a
+ * misplaced START/STOP ends with that status and the queue moves on.
+ * if SCL is held low past the clock low timeout, or the bus stays
+ * busy past the bus idle timeout, the bus is recovered before the
+ * transfer ends with I2C_MASTER_TIMEOUT: the pins are taken over as
+ * GPIO and SCL is pulsed until the slave lets go of SDA, at most 9
+ * times, followed by a STOP. that's also done by i2c_master_init()
+ * when SDA is stuck low. use both timeouts, or a stuck slave can
+ * still hold up the queue forever.
+ *
+ * built with -DI2C_MASTER_DMA, i2c_master_dma() hands the data of
+ * writes and reads of at least I2C_MASTER_DMA_MIN bytes to DMA, which
+ * then needs drivers/dma.c and a table set with dma_base_set(). the
+ * I2C acks read bytes by itself until the DMA interrupt turns that off
+ * again, which has to happen within the 8 SCL periods of the last byte.
+ */
+#ifndef I2C_MASTER_DMA_MIN
+#define I2C_MASTER_DMA_MIN 4
+#endif
+
+enum i2c_master_status {
+	I2C_MASTER_OK = 0,
+	I2C_MASTER_NACK,
+	I2C_MASTER_ARBLOST,
+	I2C_MASTER_BUSERR,
+	I2C_MASTER_TIMEOUT,
+};
+
+struct i2c_transfer {
+	struct i2c_transfer *next;
+	void (*done)(struct i2c_transfer *t);
+	const uint8_t *wbuf;
+	uint8_t *rbuf;
+	uint16_t wlen;
+	uint16_t rlen;
+	uint8_t address;
+	uint8_t status;
+};
+
+extern void i2c_master_init(uint32_t pins, uint32_t clkdiv, uint32_t config,
+		gpio_pin_t scl, gpio_pin_t sda);
+extern void i2c_master_submit(struct i2c_transfer *t);
+extern uint32_t i2c_master_busy(void);
+#ifdef I2C_MASTER_DMA
+extern void i2c_master_dma(unsigned int rx_ch, unsigned int tx_ch);
+#endif
+
+#endif
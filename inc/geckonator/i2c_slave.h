@@ -0,0 +1,41 @@
+#ifndef _GECKONATOR_I2C_SLAVE_H
+#define _GECKONATOR_I2C_SLAVE_H
+
+#include <stddef.h>
+
+#include "common.h"
+
+/*
+ * I2C slave register map, drivers/i2c_slave.c
+ * owns I2C0_IRQHandler, so it can't be used with drivers/i2c_master.c
+ *
+ * the host sees regs[] like the registers of any I2C chip. the first
+ * byte written after the address sets the register pointer and every
+ * byte after that is stored at the pointer, which then moves on and
+ * wraps at the end of the map. reads start from the pointer too, so
+ * a register is read with a write of its number, a repeated start
+ * and a read. only the first 256 registers of a larger map are used,
+ * and i2c_slave_init() fails with an empty one.
+ *
+ * the I2C acks by itself. the byte at the pointer is loaded into
+ * TXDATA again when the address matches for a read, so the host
+ * always sees what's in regs[] at that point, and the next one when
+ * the shift register takes it. only the first byte of a read may be
+ * stretched, for as long as the interrupt takes to get in.
+ * written is called with each register written, and read with each
+ * register that went out on the bus, eg. for clear on read flags.
+ * both run in the interrupt.
+ *
+ * the address match also works without HFPERCLK, so the MCU can
+ * sleep in EM2 or EM3 and is woken by the host addressing it.
+ *
+ * build with -DI2C_SLAVE_TRACE=GPIO_PA0 or some other pin set up as
+ * output and the pin is high while the interrupt handler runs, to
+ * measure the time spent per byte on a scope.
+ */
+extern int i2c_slave_init(uint32_t pins, uint8_t address,
+		uint8_t *regs, size_t size,
+		void (*written)(uint8_t reg, uint8_t v),
+		void (*read)(uint8_t reg));
+
+#endif
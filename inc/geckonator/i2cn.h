@@ -5,9 +5,15 @@ static inline void
 i2cn_(disable, void)                        { I2Cn->CTRL &= ~I2C_CTRL_EN; }
 static inline void
 i2cn_(enable, void)                         { I2Cn->CTRL |= I2C_CTRL_EN; }
+static inline void
+i2cn_(autoack_disable, void)                { I2Cn->CTRL &= ~I2C_CTRL_AUTOACK; }
+static inline void
+i2cn_(autoack_enable, void)                 { I2Cn->CTRL |= I2C_CTRL_AUTOACK; }
 
 /* I2Cn_CMD */
 static inline void
+i2cn_(command, uint32_t v)                  { I2Cn->CMD = v; }
+static inline void
 i2cn_(clear_pending, void)                  { I2Cn->CMD = I2C_CMD_CLEARPC; }
 static inline void
 i2cn_(clear_tx, void)                       { I2Cn->CMD = I2C_CMD_CLEARTX; }
@@ -233,6 +239,8 @@ static inline void
 i2cn_(flag_start_clear, void)               { I2Cn->IFC = I2C_IFC_START; }
 
 /* I2Cn_IEN */
+static inline uint32_t
+i2cn_(flags_enabled, uint32_t v)            { return v & I2Cn->IEN; }
 static inline void
 i2cn_(flags_enable, uint32_t v)             { I2Cn->IEN = v; }
 static inline void
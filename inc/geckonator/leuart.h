@@ -6,6 +6,9 @@ enum leuart_config {
 	LEUART_CONFIG_8N2 = LEUART_CTRL_DATABITS_EIGHT | LEUART_CTRL_PARITY_NONE | LEUART_CTRL_STOPBITS_TWO,
 	LEUART_CONFIG_8O1 = LEUART_CTRL_DATABITS_EIGHT | LEUART_CTRL_PARITY_ODD  | LEUART_CTRL_STOPBITS_ONE,
 	LEUART_CONFIG_8O2 = LEUART_CTRL_DATABITS_EIGHT | LEUART_CTRL_PARITY_ODD  | LEUART_CTRL_STOPBITS_TWO,
+	LEUART_CONFIG_START_FRAME_UNBLOCK = LEUART_CTRL_SFUBRX,
+	LEUART_CONFIG_RX_DMA_WAKEUP       = LEUART_CTRL_RXDMAWU,
+	LEUART_CONFIG_TX_DMA_WAKEUP       = LEUART_CTRL_TXDMAWU,
 };
 
 enum leuart_pins {
@@ -44,4 +47,10 @@ enum leuart_flags {
 	LEUART_FLAG_TX_COMPLETE     = LEUART_IF_TXC,
 };
 
+static inline uint32_t
+leuart_clock_div(uint32_t lfbclk, uint32_t baudrate)
+{
+	return ((256*lfbclk + baudrate/2) / baudrate - 256) & _LEUART_CLKDIV_DIV_MASK;
+}
+
 #endif
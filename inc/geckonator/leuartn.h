@@ -4,6 +4,8 @@ leuartn_(config, uint32_t v)               { LEUARTn->CTRL = v; }
 
 /* LEUARTn_CMD */
 static inline void
+leuartn_(command, uint32_t v)              { LEUARTn->CMD = v; }
+static inline void
 leuartn_(clear_rx, void)                   { LEUARTn->CMD = LEUART_CMD_CLEARRX; }
 static inline void
 leuartn_(clear_tx, void)                   { LEUARTn->CMD = LEUART_CMD_CLEARTX; }
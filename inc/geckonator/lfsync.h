@@ -0,0 +1,42 @@
+#ifndef _GECKONATOR_LFSYNC_H
+#define _GECKONATOR_LFSYNC_H
+
+#include "common.h"
+
+/*
+ * LF domain register writes without waiting, drivers/lfsync.c
+ *
+ * writes to the RTC, LEUART0 and the CMU LF clock registers take up
+ * to 3 LF clock cycles to cross into the LF domain, and writing again
+ * before SYNCBUSY clears loses the value. instead of spinning, queue
+ * the writes with lfsync_write() and close the batch with
+ * lfsync_commit(). once the domain is idle the whole batch is written
+ * between FREEZE and UPDATE so it takes effect in one LF cycle, and
+ * done is called when it has.
+ *
+ * there is no interrupt for SYNCBUSY, so progress is made by
+ * lfsync_poll(). call it from the main loop before sleeping or from
+ * any interrupt handler that fires often enough, it only reads the
+ * SYNCBUSY registers when nothing is ready. a later write to the same
+ * register in one batch replaces the earlier one. a batch that is
+ * committed but still waiting for the domain takes more writes until
+ * it starts, and its done is only called once they have landed too.
+ * writes made once it's in flight go into the next batch.
+ */
+#ifndef LFSYNC_QUEUE
+#define LFSYNC_QUEUE 8
+#endif
+
+enum lfsync_domain {
+	LFSYNC_CMU,
+	LFSYNC_RTC,
+	LFSYNC_LEUART0,
+	LFSYNC_DOMAINS,
+};
+
+extern int lfsync_write(enum lfsync_domain d, volatile uint32_t *reg, uint32_t v);
+extern int lfsync_commit(enum lfsync_domain d, void (*done)(void));
+extern void lfsync_poll(void);
+extern uint32_t lfsync_busy(enum lfsync_domain d);
+
+#endif
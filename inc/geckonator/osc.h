@@ -0,0 +1,42 @@
+#ifndef _GECKONATOR_OSC_H
+#define _GECKONATOR_OSC_H
+
+#include "common.h"
+
+/*
+ * crystal oscillator start up without waiting, drivers/osc.c
+ * needs drivers/clocktree.c
+ *
+ * owns the CMU interrupt. osc_start() turns the HFXO or LFXO on and
+ * returns straight away. once it's ready the CMU interrupt switches
+ * the clocks given in sel over to it and calls ready, so the start up
+ * time, milliseconds for the HFXO and up to hundreds for the LFXO, can
+ * be spent working or asleep rather than spinning at full current.
+ *
+ * osc_wait() sleeps in EM1 until the oscillator is ready and the
+ * switch made. the HFXO stops in EM2, so sleeping deeper than EM1
+ * only works for the LFXO. switching HFCLK sets flash wait states for
+ * the crystal's rate, as given to clocktree_osc_set(). ready is the
+ * place to set up dividers depending on HFCLK again. with
+ * drivers/perf.c switch HFCLK with perf_level_set() instead, after
+ * the HFXO is ready.
+ */
+enum osc {
+	OSC_HFXO,
+	OSC_LFXO,
+	OSC_COUNT,
+};
+
+enum osc_sel {
+	OSC_SEL_NONE  = 0,
+	OSC_SEL_HFCLK = 1 << 0,
+	OSC_SEL_LFA   = 1 << 1,
+	OSC_SEL_LFB   = 1 << 2,
+	OSC_SEL_LFC   = 1 << 3,
+};
+
+extern void osc_start(enum osc o, uint32_t sel, void (*ready)(enum osc o));
+extern uint32_t osc_ready(enum osc o);
+extern void osc_wait(enum osc o);
+
+#endif
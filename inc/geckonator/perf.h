@@ -0,0 +1,70 @@
+#ifndef _GECKONATOR_PERF_H
+#define _GECKONATOR_PERF_H
+
+#include "common.h"
+
+/*
+ * performance levels, drivers/perf.c
+ * needs drivers/clocktree.c
+ *
+ * each level runs HFCLK from one clock, by default the HFRCO at 1MHz
+ * for PERF_LOW, 7MHz for PERF_MID and 21MHz for PERF_MAX, to race
+ * through bursts of work at full speed and idle slowly in between.
+ * perf_level_define() changes that, eg. to the 24MHz HFXO or the
+ * USHFRCO for PERF_MAX.
+ *
+ * perf_level_set() starts the new clock, waiting for it to be ready,
+ * and then switches over with interrupts disabled. the clock left
+ * behind is turned off with clocktree_osc_put(), unless the new level
+ * runs from it too or the CMU still routes it elsewhere, eg. the
+ * USHFRCO to USB. flash wait states
+ * are added before going above PERF_FLASH_0WS_HZ and only removed
+ * once below it, so the flash is never read too fast. the HFRCO band
+ * is changed together with its factory tuning, while it isn't HFCLK
+ * where possible.
+ *
+ * drivers whose dividers depend on HFCLK, like UART baud rates or
+ * PWM periods, add a client. fn is called with PERF_BEFORE ahead of
+ * the switch, with interrupts enabled, to finish or hold off what
+ * can't be cut in two, like a character being sent, and with
+ * PERF_AFTER right after it, still with interrupts disabled, to set
+ * up the dividers again from clocktree_hfperclk() before anything
+ * runs at the new clock.
+ */
+#define PERF_FLASH_0WS_HZ 16000000
+
+enum perf_level {
+	PERF_LOW,
+	PERF_MID,
+	PERF_MAX,
+	PERF_LEVELS,
+};
+
+enum perf_clock {
+	PERF_HFRCO_1MHZ = _CMU_HFRCOCTRL_BAND_1MHZ,
+	PERF_HFRCO_7MHZ = _CMU_HFRCOCTRL_BAND_7MHZ,
+	PERF_HFRCO_11MHZ = _CMU_HFRCOCTRL_BAND_11MHZ,
+	PERF_HFRCO_14MHZ = _CMU_HFRCOCTRL_BAND_14MHZ,
+	PERF_HFRCO_21MHZ = _CMU_HFRCOCTRL_BAND_21MHZ,
+	PERF_HFXO,
+	PERF_USHFRCO,
+	PERF_LFRCO,
+};
+
+enum perf_phase {
+	PERF_BEFORE,
+	PERF_AFTER,
+};
+
+struct perf_client {
+	struct perf_client *next;
+	void (*fn)(struct perf_client *c, enum perf_phase phase);
+};
+
+extern void perf_level_define(enum perf_level level, enum perf_clock clock);
+extern int perf_level_set(enum perf_level level);
+extern enum perf_level perf_level(void);
+extern void perf_client_add(struct perf_client *c);
+extern void perf_client_remove(struct perf_client *c);
+
+#endif
@@ -48,6 +48,17 @@ enum prs_channel_config {
 	/* vcmp */
 	PRS_SOURCE_VCMP_OUT  = PRS_CH_CTRL_SOURCESEL_VCMP
 		| PRS_CH_CTRL_SIGSEL_VCMPOUT,
+	/* timer0 */
+	PRS_SOURCE_TIMER0_UF  = PRS_CH_CTRL_SOURCESEL_TIMER0
+		| PRS_CH_CTRL_SIGSEL_TIMER0UF,
+	PRS_SOURCE_TIMER0_OF  = PRS_CH_CTRL_SOURCESEL_TIMER0
+		| PRS_CH_CTRL_SIGSEL_TIMER0OF,
+	PRS_SOURCE_TIMER0_CC0 = PRS_CH_CTRL_SOURCESEL_TIMER0
+		| PRS_CH_CTRL_SIGSEL_TIMER0CC0,
+	PRS_SOURCE_TIMER0_CC1 = PRS_CH_CTRL_SOURCESEL_TIMER0
+		| PRS_CH_CTRL_SIGSEL_TIMER0CC1,
+	PRS_SOURCE_TIMER0_CC2 = PRS_CH_CTRL_SOURCESEL_TIMER0
+		| PRS_CH_CTRL_SIGSEL_TIMER0CC2,
 	/* timer1 */
 	PRS_SOURCE_TIMER1_UF  = PRS_CH_CTRL_SOURCESEL_TIMER1
 		| PRS_CH_CTRL_SIGSEL_TIMER1UF,
@@ -59,17 +70,42 @@ enum prs_channel_config {
 		| PRS_CH_CTRL_SIGSEL_TIMER1CC1,
 	PRS_SOURCE_TIMER1_CC2 = PRS_CH_CTRL_SOURCESEL_TIMER1
 		| PRS_CH_CTRL_SIGSEL_TIMER1CC2,
+	/* timer2 */
+	PRS_SOURCE_TIMER2_UF  = PRS_CH_CTRL_SOURCESEL_TIMER2
+		| PRS_CH_CTRL_SIGSEL_TIMER2UF,
+	PRS_SOURCE_TIMER2_OF  = PRS_CH_CTRL_SOURCESEL_TIMER2
+		| PRS_CH_CTRL_SIGSEL_TIMER2OF,
+	PRS_SOURCE_TIMER2_CC0 = PRS_CH_CTRL_SOURCESEL_TIMER2
+		| PRS_CH_CTRL_SIGSEL_TIMER2CC0,
+	PRS_SOURCE_TIMER2_CC1 = PRS_CH_CTRL_SOURCESEL_TIMER2
+		| PRS_CH_CTRL_SIGSEL_TIMER2CC1,
+	PRS_SOURCE_TIMER2_CC2 = PRS_CH_CTRL_SOURCESEL_TIMER2
+		| PRS_CH_CTRL_SIGSEL_TIMER2CC2,
 	/* usb */
 	PRS_SOURCE_USB_SOF   = PRS_CH_CTRL_SOURCESEL_USB
 		| PRS_CH_CTRL_SIGSEL_USBSOF,
 	PRS_SOURCE_USB_SOFSR = PRS_CH_CTRL_SOURCESEL_USB
 		| PRS_CH_CTRL_SIGSEL_USBSOFSR,
+	/* rtc */
+	PRS_SOURCE_RTC_OF    = PRS_CH_CTRL_SOURCESEL_RTC
+		| PRS_CH_CTRL_SIGSEL_RTCOF,
+	PRS_SOURCE_RTC_COMP0 = PRS_CH_CTRL_SOURCESEL_RTC
+		| PRS_CH_CTRL_SIGSEL_RTCCOMP0,
+	PRS_SOURCE_RTC_COMP1 = PRS_CH_CTRL_SOURCESEL_RTC
+		| PRS_CH_CTRL_SIGSEL_RTCCOMP1,
 };
 static inline void
 prs_channel_config(unsigned int i, uint32_t v)
 {
 	PRS->CH[i].CTRL = v;
 }
+/* pin number nr selected with gpio_flag_select() */
+static inline uint32_t
+prs_source_gpio(unsigned int nr)
+{
+	return ((nr & 0x8U) ? PRS_CH_CTRL_SOURCESEL_GPIOH : PRS_CH_CTRL_SOURCESEL_GPIOL)
+		| (nr & 0x7U) << _PRS_CH_CTRL_SIGSEL_SHIFT;
+}
 
 /* PRS_TRACECTRL */
 
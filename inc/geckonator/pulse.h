@@ -0,0 +1,47 @@
+#ifndef _GECKONATOR_PULSE_H
+#define _GECKONATOR_PULSE_H
+
+#include "common.h"
+#include "timer.h"
+
+/*
+ * one-pulse output on an input edge, drivers/pulse.c
+ *
+ * uses TIMER0 unless built with -DPULSE_TIMER=1 or 2. the clocks of
+ * the TIMER and GPIO, and PRS when the trigger comes from there, must
+ * be enabled and the CC1 pin set to push-pull.
+ *
+ * the TIMER sits stopped at 0 in one-shot mode until an edge on the
+ * CC0 input, either its pin or a PRS channel, starts it. CC1 sets
+ * its output on compare match delay ticks later and overflow clears
+ * it again width ticks after that, at which point the TIMER stops and
+ * is armed for the next edge. nothing of this goes through the CPU,
+ * so the time from edge to pulse is the same every time, down to the
+ * couple of HFPERCLK cycles the input synchroniser adds. the pulse is
+ * also found on PRS as the TIMER's CC1 source.
+ *
+ * pulse_set() gives the timing and must be called before the first
+ * edge. edges coming in while a pulse is under way are ignored. delay must
+ * be at least 1 and delay + width at most 65536 ticks of
+ * HFPERCLK/(1 << shift). if done is given it's called from the TIMER
+ * interrupt at the end of every pulse.
+ */
+#ifndef PULSE_TIMER
+#define PULSE_TIMER 0
+#endif
+
+/* take the trigger from the CC0 pin rather than PRS */
+#define PULSE_PIN -1
+
+enum pulse_trigger {
+	PULSE_RISING  = TIMER_CONFIG_RISE_START,
+	PULSE_FALLING = TIMER_CONFIG_FALL_START,
+};
+
+extern void pulse_init(uint32_t trigger, int prs_ch, uint32_t pins,
+		unsigned int shift, void (*done)(void));
+extern int pulse_set(uint32_t delay, uint32_t width);
+extern void pulse_fire(void);
+extern uint32_t pulse_busy(void);
+
+#endif
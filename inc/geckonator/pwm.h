@@ -0,0 +1,49 @@
+#ifndef _GECKONATOR_PWM_H
+#define _GECKONATOR_PWM_H
+
+#include "common.h"
+
+/*
+ * PWM on the 3 channels of a TIMER, drivers/pwm.c
+ *
+ * uses TIMER0 and its interrupt unless built with -DPWM_TIMER=1 or
+ * 2. the clocks of the TIMER and GPIO must be enabled and the pins
+ * set to push-pull.
+ *
+ * pwm_init() picks the smallest prescaler at which the period fits
+ * in 16 bits, which gives the finest duty resolution. duty cycles
+ * are fractions of the period in 1/65536, turned into compare
+ * values with a multiply and a shift. they are written to the
+ * compare buffers, so the new duty cycles of all channels and a new
+ * period from pwm_frequency_set() take effect together at the next
+ * period boundary and never cut a pulse short. pwm_update() never
+ * waits for the counter: when it's too close to the boundary to
+ * write all three in time, the overflow interrupt writes them right
+ * after it instead, a period later.
+ *
+ * PWM_CENTER counts up and down and gives pulses centred in the
+ * period, at the cost of half the resolution. dead-time insertion,
+ * for driving half-bridges from CCx and its complement CDTIx, is
+ * only found on TIMER0.
+ */
+#ifndef PWM_TIMER
+#define PWM_TIMER 0
+#endif
+
+#define PWM_CHANNELS 3
+
+enum pwm_config {
+	PWM_EDGE   = TIMER_CTRL_MODE_UP,
+	PWM_CENTER = TIMER_CTRL_MODE_UPDOWN,
+};
+
+extern int pwm_init(uint32_t hfperclk, uint32_t freq, uint32_t config,
+		uint32_t pins);
+extern int pwm_frequency_set(uint32_t freq);
+extern void pwm_update(const uint16_t duty[PWM_CHANNELS]);
+extern void pwm_duty_set(unsigned int ch, uint16_t duty);
+#if PWM_TIMER == 0
+extern void pwm_dead_time(uint32_t config, uint32_t time);
+#endif
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef _GECKONATOR_QDEC_H
+#define _GECKONATOR_QDEC_H
+
+#include "common.h"
+
+/*
+ * quadrature decoder, drivers/qdec.c
+ *
+ * uses TIMER0 unless built with -DQDEC_TIMER=1 or 2. the encoder
+ * outputs A and B go to the CC0 and CC1 inputs of the TIMER at the
+ * location given in pins, set up as GPIO inputs. the clocks of the
+ * TIMER, GPIO and, for velocity, PRS must be enabled.
+ *
+ * the TIMER counts each edge of A with TIMER_CONFIG_QDEC_X2 or of both
+ * A and B with TIMER_CONFIG_QDEC_X4, up or down, by itself. the only
+ * interrupts are when it wraps, which extends the position to 32 bits,
+ * so the CPU load hardly depends on the speed of the encoder. should
+ * it wrap both ways before the interrupt runs, the position is taken
+ * to be the one nearest to where it was.
+ *
+ * for velocity, pass a PRS channel carrying a steady tick, eg.
+ * PRS_SOURCE_RTC_COMP0 with COMP0 as the RTC's top, or the overflow of
+ * another TIMER. each tick captures the count on CC2 in hardware and
+ * the interrupt works out the change since the last, so there is no
+ * jitter from interrupt latency. qdec_velocity() then gives the counts
+ * per tick, and sample, if set, is called from the interrupt with it.
+ */
+#ifndef QDEC_TIMER
+#define QDEC_TIMER 0
+#endif
+
+#define QDEC_NONE (-1)
+
+extern void qdec_init(uint32_t config, uint32_t pins, int gate_prs_ch,
+		void (*sample)(int32_t velocity));
+extern int32_t qdec_position(void);
+extern int32_t qdec_velocity(void);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef _GECKONATOR_RS485_H
+#define _GECKONATOR_RS485_H
+
+#include <stddef.h>
+
+#include "common.h"
+#include "gpio.h"
+
+/*
+ * RS-485 multidrop driver, drivers/rs485.c
+ * needs drivers/dma.c and a descriptor table set with dma_base_set()
+ *
+ * uses USART1 unless built with -DRS485_USART=0.
+ *
+ * packets are a 9 bit address frame with bit 8 set, a length
+ * byte and that many data bytes. the USART runs in multi-processor
+ * mode with the receiver blocked, so frames sent to other nodes
+ * never reach the RX buffer. only an address frame interrupts, and
+ * on a match the length byte is read and the rest received by DMA.
+ *
+ * the transceiver driver enable is either a GPIO set while sending
+ * and cleared from the TX complete interrupt after the last stop bit,
+ * or with RS485_CONFIG_AUTOTRI the TX pin is tristated by the USART
+ * whenever it's idle.
+ */
+#ifndef RS485_USART
+#define RS485_USART 1
+#endif
+
+#define RS485_BROADCAST 0xFFU
+
+enum rs485_config {
+	RS485_CONFIG_DE      = 0,
+	RS485_CONFIG_AUTOTRI = USART_CTRL_AUTOTRI,
+};
+
+extern void rs485_init(uint32_t pins, uint32_t clkdiv, uint32_t config,
+		gpio_pin_t de, unsigned int rx_ch, unsigned int tx_ch);
+extern void rs485_address_set(uint8_t address);
+extern void rs485_receive(uint8_t *buf, size_t size,
+		void (*done)(uint8_t *buf, size_t len));
+extern int rs485_send(uint8_t address, const uint8_t *data, size_t len,
+		void (*done)(void));
+extern uint32_t rs485_sending(void);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _GECKONATOR_SWTIMER_H
+#define _GECKONATOR_SWTIMER_H
+
+#include <stddef.h>
+
+#include "common.h"
+
+/*
+ * software timers on the RTC, drivers/swtimer.c
+ * needs drivers/lfsync.c
+ *
+ * owns the RTC and its interrupt. the LE clock and RTC clock must be
+ * set up and enabled before swtimer_init(), like in main.c. time is
+ * counted in RTC ticks and extended from 24 to 32 bits, halfway
+ * through the count on COMP1 and at the end on overflow, so deadlines
+ * up to 2^31 ticks ahead work across the RTC wrapping.
+ *
+ * timers are kept in a hierarchical wheel, 4 levels of 32 slots each
+ * 32 times coarser than the one below, plus a list for those further
+ * out than 2^20 ticks. adding and cancelling a timer is a few pointer
+ * operations, and as time passes a timer moves down a level at most
+ * once per level. COMP0 is only ever set for the nearest point at
+ * which something has to happen, so the CPU sleeps in between.
+ *
+ * COMP0 is written through lfsync, so nothing ever waits for the RTC.
+ * as a write takes a few RTC ticks to take effect, a timer that is
+ * due within 3 ticks when the interrupt looks runs right then, up to
+ * those 3 ticks early. a new COMP0 value may have to wait for the
+ * previous one to land, and there is no interrupt for that, so the
+ * main loop should keep calling lfsync_poll() rather than sleep while
+ * lfsync_busy(LFSYNC_RTC). that's a few LF cycles after each change.
+ *
+ * fill in fn, and period for a timer that repeats, then add it with
+ * swtimer_at() or swtimer_after(). fn is called from the RTC
+ * interrupt, and may add and cancel timers, including itself. all
+ * functions may be called from interrupt handlers.
+ */
+struct swtimer {
+	struct swtimer *next;
+	struct swtimer **pprev;
+	void (*fn)(struct swtimer *t);
+	uint32_t expires;
+	uint32_t period;   /* 0 to fire once */
+	uint8_t index;
+};
+
+extern void swtimer_init(void);
+extern uint32_t swtimer_now(void);
+extern void swtimer_at(struct swtimer *t, uint32_t expires);
+extern void swtimer_after(struct swtimer *t, uint32_t ticks);
+extern void swtimer_cancel(struct swtimer *t);
+
+static inline uint32_t
+swtimer_pending(const struct swtimer *t)
+{
+	return t->pprev != NULL;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef _GECKONATOR_TIMEBASE_H
+#define _GECKONATOR_TIMEBASE_H
+
+#include "common.h"
+
+/*
+ * 64 bit monotonic time, drivers/timebase.c
+ *
+ * uses TIMER0 unless built with -DTIMEBASE_TIMER=1 or 2, counting
+ * HFPERCLK/(1 << shift), which must be at least 1MHz. the TIMER clock
+ * must be enabled.
+ *
+ * the interrupt bumps an epoch twice per 65536 ticks, on overflow and
+ * halfway at CC0, so the lowest bit of the epoch says which half of
+ * the count it belongs to. a reader compares that with the top bit
+ * of the counter: if they differ the interrupt is still pending and
+ * the epoch is one behind. reading is then just re-reading the epoch
+ * until it didn't change underneath, without disabling interrupts,
+ * and works from any interrupt handler as long as the timebase
+ * interrupt is never held off for more than 32768 ticks.
+ *
+ * microseconds are worked out with a multiply by a 0.32 fixed point
+ * factor set up by timebase_init(), which is off by at most a few
+ * parts per billion.
+ */
+#ifndef TIMEBASE_TIMER
+#define TIMEBASE_TIMER 0
+#endif
+
+extern int timebase_init(uint32_t hfperclk, unsigned int shift);
+extern uint64_t timebase_ticks(void);
+extern uint32_t timebase_ticks32(void);
+extern uint64_t timebase_ticks_to_us(uint64_t ticks);
+extern uint64_t timebase_us_to_ticks(uint32_t us);
+
+static inline uint64_t
+timebase_us(void)
+{
+	return timebase_ticks_to_us(timebase_ticks());
+}
+
+#endif
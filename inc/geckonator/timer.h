@@ -5,12 +5,29 @@ enum timer_config {
 	TIMER_CONFIG_DEBUGRUN   = TIMER_CTRL_DEBUGRUN,
 	TIMER_CONFIG_ONESHOT    = TIMER_CTRL_OSMEN,
 	TIMER_CONFIG_SYNC       = TIMER_CTRL_SYNC,
+	TIMER_CONFIG_DMACLRACT  = TIMER_CTRL_DMACLRACT,
 	TIMER_CONFIG_UP         = TIMER_CTRL_MODE_UP,
 	TIMER_CONFIG_DOWN       = TIMER_CTRL_MODE_DOWN,
 	TIMER_CONFIG_UPDOWN     = TIMER_CTRL_MODE_UPDOWN,
 	TIMER_CONFIG_QDEC       = TIMER_CTRL_MODE_QDEC,
+	TIMER_CONFIG_QDEC_X2    = TIMER_CTRL_MODE_QDEC | TIMER_CTRL_QDM_X2,
+	TIMER_CONFIG_QDEC_X4    = TIMER_CTRL_MODE_QDEC | TIMER_CTRL_QDM_X4,
+	/* what a rising or falling edge on the CC0 input does */
+	TIMER_CONFIG_RISE_START       = TIMER_CTRL_RISEA_START,
+	TIMER_CONFIG_RISE_STOP        = TIMER_CTRL_RISEA_STOP,
+	TIMER_CONFIG_RISE_RELOADSTART = TIMER_CTRL_RISEA_RELOADSTART,
+	TIMER_CONFIG_FALL_START       = TIMER_CTRL_FALLA_START,
+	TIMER_CONFIG_FALL_STOP        = TIMER_CTRL_FALLA_STOP,
+	TIMER_CONFIG_FALL_RELOADSTART = TIMER_CTRL_FALLA_RELOADSTART,
 };
 
+/* HFPERCLK divided by 1 << shift, 0 to 10 */
+static inline uint32_t
+timer_prescaler(unsigned int shift)
+{
+	return shift << _TIMER_CTRL_PRESC_SHIFT;
+}
+
 enum timer_pins {
 	TIMER_PINS_LOCATION0    = TIMER_ROUTE_LOCATION_LOC0,
 	TIMER_PINS_LOCATION1    = TIMER_ROUTE_LOCATION_LOC1,
@@ -22,6 +39,9 @@ enum timer_pins {
 	TIMER_PINS_CC2_ENABLE   = TIMER_ROUTE_CC2PEN,
 	TIMER_PINS_CC1_ENABLE   = TIMER_ROUTE_CC1PEN,
 	TIMER_PINS_CC0_ENABLE   = TIMER_ROUTE_CC0PEN,
+	TIMER_PINS_CDTI2_ENABLE = TIMER_ROUTE_CDTI2PEN,
+	TIMER_PINS_CDTI1_ENABLE = TIMER_ROUTE_CDTI1PEN,
+	TIMER_PINS_CDTI0_ENABLE = TIMER_ROUTE_CDTI0PEN,
 };
 
 enum timer_cc_config {
@@ -29,6 +49,41 @@ enum timer_cc_config {
 	TIMER_CC_CONFIG_CAPTURE = TIMER_CC_CTRL_MODE_INPUTCAPTURE,
 	TIMER_CC_CONFIG_COMPARE = TIMER_CC_CTRL_MODE_OUTPUTCOMPARE,
 	TIMER_CC_CONFIG_PWM     = TIMER_CC_CTRL_MODE_PWM,
+	TIMER_CC_CONFIG_PRS     = TIMER_CC_CTRL_INSEL_PRS,
+	TIMER_CC_CONFIG_FILTER  = TIMER_CC_CTRL_FILT_ENABLE,
+	TIMER_CC_CONFIG_RISING  = TIMER_CC_CTRL_ICEDGE_RISING,
+	TIMER_CC_CONFIG_FALLING = TIMER_CC_CTRL_ICEDGE_FALLING,
+	TIMER_CC_CONFIG_BOTH    = TIMER_CC_CTRL_ICEDGE_BOTH,
+	/* compare output initial state and what compare match and overflow do to it */
+	TIMER_CC_CONFIG_INITIAL_HIGH    = TIMER_CC_CTRL_COIST,
+	TIMER_CC_CONFIG_MATCH_TOGGLE    = TIMER_CC_CTRL_CMOA_TOGGLE,
+	TIMER_CC_CONFIG_MATCH_CLEAR     = TIMER_CC_CTRL_CMOA_CLEAR,
+	TIMER_CC_CONFIG_MATCH_SET       = TIMER_CC_CTRL_CMOA_SET,
+	TIMER_CC_CONFIG_OVERFLOW_TOGGLE = TIMER_CC_CTRL_COFOA_TOGGLE,
+	TIMER_CC_CONFIG_OVERFLOW_CLEAR  = TIMER_CC_CTRL_COFOA_CLEAR,
+	TIMER_CC_CONFIG_OVERFLOW_SET    = TIMER_CC_CTRL_COFOA_SET,
+};
+
+enum timer_dti_config {
+	TIMER_DTI_ENABLE        = TIMER_DTCTRL_DTEN,
+	TIMER_DTI_AUTOSTART     = TIMER_DTCTRL_DTDAS,
+	TIMER_DTI_INACTIVE_HIGH = TIMER_DTCTRL_DTIPOL,
+	TIMER_DTI_CDTI_INVERT   = TIMER_DTCTRL_DTCINV,
 };
 
+/* HFPERCLK divided by 1 << shift, then rise and fall times of 1 to 64 cycles */
+static inline uint32_t
+timer_dti_time(unsigned int shift, unsigned int rise, unsigned int fall)
+{
+	return shift << _TIMER_DTTIME_DTPRESC_SHIFT
+		| (rise - 1) << _TIMER_DTTIME_DTRISET_SHIFT
+		| (fall - 1) << _TIMER_DTTIME_DTFALLT_SHIFT;
+}
+
+static inline uint32_t
+timer_cc_prs_channel(unsigned int ch)
+{
+	return ch << _TIMER_CC_CTRL_PRSSEL_SHIFT;
+}
+
 #endif
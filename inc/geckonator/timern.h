@@ -277,16 +277,22 @@ timern_(cc_buffer, unsigned int i)        { return TIMERn->CC[i].CCVB; }
 static inline void
 timern_(cc_buffer_set, unsigned int i, uint32_t v)
 {
-	TIMERn->CC[i].CCV = v;
+	TIMERn->CC[i].CCVB = v;
 }
 
 /* TIMERn_DTCTRL */
+static inline void
+timern_(dti_config, uint32_t v)           { TIMERn->DTCTRL = v; }
 
 /* TIMERn_DTTIME */
+static inline void
+timern_(dti_time, uint32_t v)             { TIMERn->DTTIME = v; }
 
 /* TIMERn_DTFC */
 
 /* TIMERn_DTOGEN */
+static inline void
+timern_(dti_outputs, uint32_t v)          { TIMERn->DTOGEN = v; }
 
 /* TIMERn_DTFAULT */
 
@@ -17,4 +17,11 @@ enum usart_flags {
 	USART_FLAG_TX_COMPLETE     = USART_IF_TXC,
 };
 
+/* asynchronous mode with 16x oversampling */
+static inline uint32_t
+usart_clock_div(uint32_t hfperclk, uint32_t baudrate)
+{
+	return ((16*hfperclk + baudrate/2) / baudrate - 256) & _USART_CLKDIV_DIV_MASK;
+}
+
 #endif
@@ -15,6 +15,13 @@ usartn_(frame_8n1, void)
 		      | USART_FRAME_DATABITS_EIGHT;
 }
 static inline void
+usartn_(frame_9n1, void)
+{
+	USARTn->FRAME = USART_FRAME_STOPBITS_ONE
+	              | USART_FRAME_PARITY_NONE
+		      | USART_FRAME_DATABITS_NINE;
+}
+static inline void
 usartn_(frame_bits, unsigned int n)
 {
 	USARTn->FRAME = n - 3;
@@ -89,6 +96,8 @@ static inline void
 usartn_(clock_div, uint32_t v)            { USARTn->CLKDIV = v; }
 
 /* USARTn_RXDATAX */
+static inline uint32_t
+usartn_(rxdatax, void)                    { return USARTn->RXDATAX; }
 
 /* USARTn_RXDATA */
 static inline uint32_t
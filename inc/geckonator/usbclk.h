@@ -0,0 +1,35 @@
+#ifndef _GECKONATOR_USBCLK_H
+#define _GECKONATOR_USBCLK_H
+
+#include "common.h"
+
+/*
+ * USB clock from the USHFRCO locked to the host, drivers/usbclk.c
+ * needs drivers/swtimer.c, set up with swtimer_init() first
+ *
+ * for crystal-less full speed devices. usbclk_start() loads the
+ * factory tuning of the 48MHz band, runs the USB core from the
+ * USHFRCO and turns on its clock recovery, which retunes it on every
+ * start of frame from the host. the USB core clock must be enabled.
+ *
+ * the recovery has no lock indicator of its own, so every poll RTC
+ * ticks a software timer looks at the USB frame number and the
+ * USHFRCO tuning. the clock counts as locked when frames are coming
+ * in and the tuning has stayed within USBCLK_LOCK_SPREAD fine steps
+ * over the last USBCLK_HISTORY looks. changed is called from the RTC
+ * interrupt whenever that changes, eg. to hold off isochronous
+ * streaming until the clock is good.
+ */
+#ifndef USBCLK_HISTORY
+#define USBCLK_HISTORY 4
+#endif
+
+#ifndef USBCLK_LOCK_SPREAD
+#define USBCLK_LOCK_SPREAD 4
+#endif
+
+extern void usbclk_start(uint32_t poll, void (*changed)(uint32_t locked));
+extern void usbclk_stop(void);
+extern uint32_t usbclk_locked(void);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef _GECKONATOR_WAVE_H
+#define _GECKONATOR_WAVE_H
+
+#include <stddef.h>
+
+#include "common.h"
+
+/*
+ * timed GPIO waveforms, drivers/wave.c
+ * needs drivers/dma.c and a descriptor table set with dma_base_set()
+ *
+ * uses TIMER0 unless built with -DWAVE_TIMER=1 or 2. each overflow of
+ * the TIMER, every top + 1 ticks of HFPERCLK/(1 << shift), makes the
+ * DMA write the next word of a table to DOUT of a GPIO port, or to
+ * DOUTTGL to flip just the pins set in it. the pins change on the
+ * TIMER's clock no matter what the CPU is doing, and there is no
+ * interrupt per step. the clocks of the TIMER, GPIO and DMA must be
+ * enabled and the pins set as outputs. DOUT sets all pins of the port.
+ *
+ * wave_loop() plays a table loops times, or forever with 0. the
+ * primary and alternate descriptors both point at it and take turns,
+ * so one is always armed and loops join up without a gap. the DMA
+ * interrupt only has to re-arm the other before a whole table has
+ * played.
+ *
+ * wave_stream() plays two buffers in turn. refill is called from the
+ * DMA interrupt to fill the one which just played, which then goes
+ * out after the other, until wave_stop().
+ */
+#define WAVE_MAX 1024
+
+enum wave_target {
+	WAVE_DOUT,
+	WAVE_DOUTTGL,
+};
+
+extern void wave_init(unsigned int dma_ch, unsigned int port,
+		enum wave_target target, unsigned int shift, uint32_t top);
+extern int wave_loop(const uint32_t *table, size_t len, uint32_t loops,
+		void (*done)(void));
+extern int wave_stream(uint32_t *buf0, uint32_t *buf1, size_t len,
+		void (*refill)(uint32_t *buf, size_t len));
+extern void wave_stop(void);
+extern uint32_t wave_busy(void);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef _GECKONATOR_WS2812_H
+#define _GECKONATOR_WS2812_H
+
+#include <stddef.h>
+
+#include "common.h"
+
+/*
+ * WS2812/SK6812 driver, drivers/ws2812.c
+ * needs drivers/dma.c and a descriptor table set with dma_base_set()
+ *
+ * every data bit is sent as 3 synchronous USART bits, 100 for 0 and
+ * 110 for 1, at WS2812_BITRATE. each nibble is one 12 bit frame, so
+ * the line is low between frames and a late DMA transfer only
+ * stretches a low period. the frames are encoded WS2812_CHUNK bytes
+ * at a time into two buffers streamed by ping-pong DMA, and the
+ * transfer ends with WS2812_RESET_FRAMES low frames to latch the data.
+ *
+ * HFPERCLK must be at least 14MHz to get the bit timing right and
+ * the DMA interrupt must be served within one chunk, 10us per byte.
+ */
+#define WS2812_BITRATE 2400000U
+
+#ifndef WS2812_CHUNK
+#define WS2812_CHUNK 24
+#endif
+
+#ifndef WS2812_RESET_FRAMES
+#define WS2812_RESET_FRAMES 64
+#endif
+
+extern void ws2812_init(USART_TypeDef *usart, uint32_t pins,
+		unsigned int ch, uint32_t hfperclk);
+extern void __ramfunc ws2812_encode(uint16_t *dst, const uint8_t *src, size_t len);
+extern int ws2812_write(const uint8_t *data, size_t len, void (*done)(void));
+extern uint32_t ws2812_busy(void);
+
+#endif
@@ -17,6 +17,9 @@
 # Try uncommenting this if the build fails
 #OLD = 1
 
+# Drivers from drivers/ to link in, eg. DRIVERS = dma ws2812
+DRIVERS   ?=
+
 NAME       = code
 OUTDIR     = out
 DESTDIR    = .
@@ -101,6 +104,7 @@ endif
 headers  = $(wildcard *.h)
 sources  = $(filter-out init.% geckonator.%,$(wildcard *.S) $(wildcard *.c))
 objects  = $(OUTDIR)/init.o $(OUTDIR)/geckonator.o
+objects += $(patsubst %,$(OUTDIR)/drivers/%.o,$(DRIVERS))
 objects += $(patsubst %,$(OUTDIR)/%.o,$(basename $(filter %.S %.c,$(sources))))
 
 .SECONDEXPANSION: